@@ -2,34 +2,17 @@
 #include <vector>
 #include <string>
 
+#include <unistd.h>
+
 #include "ml_lib/tensor.h"
 #include "ml_lib/model.h"
 #include "ml_lib/replay_memory.h"
+#include "ml_lib/checkpoint.h"
 
 #include "actor-critic-chess-agent/environment.h"
 
 #define LOG(x) std::cout << x << std::endl
-    ml_lib::Tensor chess_agent::ActorFeedForward(const ml_lib::Tensor& board_state, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model) 
-    {
-        // board_state shape = {8, 8, 16, 2}
-        auto out = board_state;
-        
-        unsigned int batchsize = out.get_num_elements() / 2048;
-        out = out.Reshape({2048, batchsize});
-
-        for(unsigned int i = 0; i < actor_model.size() -1; i++) {
-            out = actor_model[i]->FeedForward(out);
-        }
-
-        out = out.HadamardMult(action_space);
-
-        //out = actor_model.back()->FeedForward(out);
 
-        out = out.Reshape({8, 8, 16, batchsize});
-
-        return out;
-    }
-   
 class Test {
 public:
     Test():
@@ -54,7 +37,19 @@ private:
     ml_lib::Tensor m_t;
 };
 
-int main() {
+int main(int argc, char** argv) {
+    // usage: main [checkpoint_path]
+    //        main --self-play-actor <shm_name> <actor_id> (started by the learner, see chess_agent::SelfPlayProcesses)
+    //        main --benchmark <output_path> [games] [max_moves_per_game] [seed]
+    bool self_play_actor = argc > 3 && std::string(argv[1]) == "--self-play-actor";
+    bool benchmark = argc > 2 && std::string(argv[1]) == "--benchmark";
+    std::string checkpoint_path = argc > 1 && !self_play_actor && !benchmark ? argv[1] : "actor_model.ckpt";
+
+    // the actor weights have to be the same for every benchmark run
+    unsigned int benchmark_seed = argc > 5 && benchmark ? std::stoul(argv[5]) : 0;
+    if(benchmark)
+        std::srand(benchmark_seed);
+
     // actor
     ml_lib::layer_type::Linear actor_l1(2048, 1024, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
     ml_lib::layer_type::Linear actor_l2(1024, 1024, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
@@ -62,7 +57,30 @@ int main() {
     ml_lib::layer_type::Softmax actor_norm(2);
     std::vector<ml_lib::LayerBase*> actor_model = {&actor_l1, &actor_l2, &actor_l3};
 
-    chess_agent::train(2, actor_model);
+    if(self_play_actor) {
+        chess_agent::RunSelfPlayProcess(argv[2], std::stoul(argv[3]), actor_model);
+        return 0;
+    }
+
+    if(benchmark) {
+        unsigned int num_games = argc > 3 ? std::stoul(argv[3]) : 4;
+        unsigned int max_moves_per_game = argc > 4 ? std::stoul(argv[4]) : 20;
+
+        chess_agent::benchmark(num_games, max_moves_per_game, benchmark_seed, actor_model, argv[2]);
+        return 0;
+    }
+
+    if(access(checkpoint_path.c_str(), F_OK) == 0) {
+        // reuse the trained weights instead of retraining from random weights
+        LOG("[+] loading " << checkpoint_path);
+        ml_lib::checkpoint::Load(checkpoint_path, actor_model);
+    } else {
+        chess_agent::train(2, actor_model);
+
+        LOG("[+] saving " << checkpoint_path);
+        ml_lib::checkpoint::Save(checkpoint_path, actor_model);
+    }
+
     chess_agent::test(actor_model);
 
     return 0;
@@ -0,0 +1,351 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <cstdlib>
+#include <new>
+
+#include "ml_lib/tensor.h"
+#include "ml_lib/sparse_tensor.h"
+#include "ml_lib/model.h"
+
+// counts every heap allocation of the process (including the ones inside ml_lib)
+// delete is kept out of line, otherwise gcc sees new paired with free at the inlined call sites
+static std::atomic<unsigned long long> g_num_allocations(0);
+
+void *operator new(std::size_t size)
+{
+    g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+[[gnu::noinline]] void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void *memory) noexcept
+{
+    operator delete(memory);
+}
+void operator delete(void *memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+// microbenchmarks of the tensor ops with the shapes used by the chess agent
+// usage: ml_lib_bench [--batchsizes 1,8] [--min-time seconds] [--filter substring] [--json path]
+// flops and bytes are nominal: every element counts as one double read or written once
+struct BenchCase
+{
+    std::string op;
+    std::string shape;
+    double flops;
+    double bytes;
+
+    std::function<std::vector<ml_lib::Tensor>()> make_inputs;
+    std::function<ml_lib::Tensor(const std::vector<ml_lib::Tensor> &)> forward;
+};
+
+struct BenchResult
+{
+    std::string op;
+    std::string shape;
+    std::string pass;
+    unsigned long long iterations;
+    double seconds_per_op;
+    double gflops;
+    double gbytes_per_second;
+    double allocations_per_op;
+};
+
+ml_lib::Tensor RandomTensor(const std::vector<unsigned int> &shape, std::mt19937 &rng)
+{
+    unsigned int num_elements = 1;
+    for (const unsigned int &dimension : shape)
+        num_elements *= dimension;
+
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+    std::vector<double> values(num_elements);
+    for (double &value : values)
+        value = distribution(rng);
+
+    return ml_lib::Tensor(shape, values.data(), true);
+}
+
+ml_lib::Tensor ReduceToScalar(ml_lib::Tensor tensor)
+{
+    for (unsigned int axis = 0; axis < tensor.get_dimensions(); axis++)
+        tensor = tensor.Sum(axis);
+
+    return tensor;
+}
+
+std::string ShapeString(const std::vector<unsigned int> &shape)
+{
+    std::string shape_string = "{";
+
+    for (unsigned int i = 0; i < shape.size(); i++)
+    {
+        if (i > 0)
+            shape_string += ',';
+        shape_string += std::to_string(shape[i]);
+    }
+
+    return shape_string + "}";
+}
+
+std::vector<BenchCase> GenerateBenchCases(const unsigned int &batchsize, std::mt19937 &rng)
+{
+    std::vector<BenchCase> bench_cases;
+    double b = batchsize;
+
+    // actor layer 1: weights {1024, 2048} times board state {2048, B}
+    bench_cases.push_back({"MatrixMult",
+                           ShapeString({1024, 2048}) + "x" + ShapeString({2048, batchsize}),
+                           2. * 1024 * 2048 * b,
+                           8. * (1024 * 2048 + 2048 * b + 1024 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({1024, 2048}, rng), RandomTensor({2048, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return in[0].MatrixMult(in[1]); }});
+
+    // actor layer 1 with the sparse board state (32 pieces per batch element)
+    bench_cases.push_back({"MatrixMultSparse",
+                           ShapeString({1024, 2048}) + "x" + ShapeString({2048, batchsize}) + "[32 active]",
+                           2. * 1024 * 32 * b,
+                           8. * (1024 * 32 * b + 1024 * b),
+                           [&rng]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({1024, 2048}, rng)}; },
+                           [&rng, batchsize](const std::vector<ml_lib::Tensor> &in)
+                           {
+                               std::vector<std::vector<unsigned int>> active_indices(batchsize);
+                               for (auto &batch_element_indices : active_indices)
+                                   for (unsigned int piece_id = 0; piece_id < 32; piece_id++)
+                                       batch_element_indices.push_back(rng() % 64 + piece_id * 64);
+
+                               return in[0].MatrixMult(ml_lib::SparseTensor(2048, active_indices));
+                           }});
+
+    // actor layers 2 and 3
+    bench_cases.push_back({"MatrixMult",
+                           ShapeString({1024, 1024}) + "x" + ShapeString({1024, batchsize}),
+                           2. * 1024 * 1024 * b,
+                           8. * (1024 * 1024 + 1024 * b + 1024 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({1024, 1024}, rng), RandomTensor({1024, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return in[0].MatrixMult(in[1]); }});
+
+    bench_cases.push_back({"Sum",
+                           ShapeString({1024, batchsize}) + "/0",
+                           1024 * b,
+                           8. * (1024 * b + b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({1024, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return in[0].Sum(0); }});
+    bench_cases.push_back({"Sum",
+                           ShapeString({8, 8, 16, batchsize}) + "/2",
+                           1024 * b,
+                           8. * (1024 * b + 64 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({8, 8, 16, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return in[0].Sum(2); }});
+
+    // bias of a Linear layer
+    bench_cases.push_back({"Repeat",
+                           ShapeString({1024, 1}) + "/1x" + std::to_string(batchsize),
+                           0.,
+                           8. * (1024 + 1024 * b),
+                           [&rng]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({1024, 1}, rng)}; },
+                           [batchsize](const std::vector<ml_lib::Tensor> &in)
+                           { return in[0].Repeat(1, batchsize); }});
+
+    // critic input: board state and actions
+    bench_cases.push_back({"Concatenate",
+                           ShapeString({2048, batchsize}) + "+" + ShapeString({1024, batchsize}) + "/0",
+                           0.,
+                           8. * 2 * (3072 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({2048, batchsize}, rng), RandomTensor({1024, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return ml_lib::Tensor::Concatenate(in[0], in[1], 0); }});
+    bench_cases.push_back({"Concatenate",
+                           ShapeString({8, 8, 16, batchsize}) + "+" + ShapeString({8, 8, 16, batchsize}) + "/3",
+                           0.,
+                           8. * 2 * (2048 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({8, 8, 16, batchsize}, rng), RandomTensor({8, 8, 16, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return ml_lib::Tensor::Concatenate(in[0], in[1], 3); }});
+
+    // exp, sum, reciprocal and product per element
+    bench_cases.push_back({"Softmax",
+                           ShapeString({1024, batchsize}) + "/0",
+                           4. * 1024 * b,
+                           8. * (2 * 1024 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({1024, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return ml_lib::layer_type::Softmax(0).FeedForward(in[0]); }});
+    bench_cases.push_back({"Softmax",
+                           ShapeString({8, 8, 16, batchsize}) + "/2",
+                           4. * 1024 * b,
+                           8. * (2 * 1024 * b),
+                           [&rng, batchsize]()
+                           { return std::vector<ml_lib::Tensor>{RandomTensor({8, 8, 16, batchsize}, rng)}; },
+                           [](const std::vector<ml_lib::Tensor> &in)
+                           { return ml_lib::layer_type::Softmax(2).FeedForward(in[0]); }});
+
+    return bench_cases;
+}
+
+BenchResult Measure(const BenchCase &bench_case, const bool &backward, const double &min_time)
+{
+    unsigned long long iterations = 0;
+    unsigned long long allocations = 0;
+    std::chrono::duration<double> time(0.);
+
+    while (iterations == 0 || time.count() < min_time)
+    {
+        // fresh inputs every iteration, otherwise the autodiff graph of the inputs keeps growing
+        std::vector<ml_lib::Tensor> inputs = bench_case.make_inputs();
+        ml_lib::Tensor out = ml_lib::Tensor::Empty();
+
+        if (backward)
+            out = ReduceToScalar(bench_case.forward(inputs));
+
+        unsigned long long allocations_before = g_num_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+
+        if (backward)
+            out.Backward();
+        else
+            out = bench_case.forward(inputs);
+
+        time += std::chrono::steady_clock::now() - start;
+        allocations += g_num_allocations.load() - allocations_before;
+        iterations++;
+    }
+
+    double seconds_per_op = time.count() / iterations;
+
+    // the backward pass touches every element once more and does about twice the flops
+    double pass_factor = backward ? 2. : 1.;
+
+    return {bench_case.op,
+            bench_case.shape,
+            backward ? "backward" : "forward",
+            iterations,
+            seconds_per_op,
+            pass_factor * bench_case.flops / seconds_per_op / 1e9,
+            pass_factor * bench_case.bytes / seconds_per_op / 1e9,
+            (double)allocations / iterations};
+}
+
+void WriteJson(std::ostream &out, const std::vector<BenchResult> &results)
+{
+    out << "{\n  \"benchmark\": \"ml_lib_bench\",\n  \"results\": [\n";
+
+    for (unsigned int i = 0; i < results.size(); i++)
+    {
+        const BenchResult &result = results[i];
+
+        out << "    {\"op\": \"" << result.op << "\", "
+            << "\"shape\": \"" << result.shape << "\", "
+            << "\"pass\": \"" << result.pass << "\", "
+            << "\"iterations\": " << result.iterations << ", "
+            << "\"ns_per_op\": " << result.seconds_per_op * 1e9 << ", "
+            << "\"gflops\": " << result.gflops << ", "
+            << "\"gbytes_per_second\": " << result.gbytes_per_second << ", "
+            << "\"allocations_per_op\": " << result.allocations_per_op << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<unsigned int> batchsizes = {1, 8};
+    double min_time = 0.2;
+    std::string filter;
+    std::string json_path;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+
+        if (option == "--batchsizes")
+        {
+            batchsizes.clear();
+
+            std::stringstream batchsize_list(value);
+            std::string batchsize;
+            while (std::getline(batchsize_list, batchsize, ','))
+                batchsizes.push_back(std::stoul(batchsize));
+        }
+        else if (option == "--min-time")
+            min_time = std::stod(value);
+        else if (option == "--filter")
+            filter = value;
+        else if (option == "--json")
+            json_path = value;
+        else
+        {
+            std::cout << "usage: ml_lib_bench [--batchsizes 1,8] [--min-time seconds] [--filter substring] [--json path]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(0);
+    std::vector<BenchResult> results;
+
+    for (const unsigned int &batchsize : batchsizes)
+    {
+        for (const BenchCase &bench_case : GenerateBenchCases(batchsize, rng))
+        {
+            if (!filter.empty() && bench_case.op.find(filter) == std::string::npos)
+                continue;
+
+            for (bool backward : {false, true})
+            {
+                BenchResult result = Measure(bench_case, backward, min_time);
+                results.push_back(result);
+
+                std::cout << result.op << " " << result.shape << " " << result.pass << ": "
+                          << result.seconds_per_op * 1e6 << " us/op, "
+                          << result.gflops << " GFLOP/s, "
+                          << result.gbytes_per_second << " GB/s, "
+                          << result.allocations_per_op << " allocs/op" << std::endl;
+            }
+        }
+    }
+
+    if (!json_path.empty())
+    {
+        std::ofstream json_file(json_path);
+        WriteJson(json_file, results);
+    }
+
+    return 0;
+}
\ No newline at end of file
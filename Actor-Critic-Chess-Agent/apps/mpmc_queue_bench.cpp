@@ -0,0 +1,140 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "ml_lib/mpmc_queue.h"
+
+// stress benchmark for ml_lib::MpmcQueue
+// usage: mpmc_queue_bench [producers] [consumers] [items per producer] [capacity]
+// every item is popped exactly once (checked by sum and count), throughput and the drops of the TryPush pass are reported
+int main(int argc, char **argv)
+{
+    unsigned int num_producers = argc > 1 ? std::stoul(argv[1]) : 4;
+    unsigned int num_consumers = argc > 2 ? std::stoul(argv[2]) : 4;
+    unsigned long long num_items_per_producer = argc > 3 ? std::stoull(argv[3]) : 1000000;
+    std::size_t capacity = argc > 4 ? std::stoull(argv[4]) : 1024;
+
+    if (num_producers == 0 || num_consumers == 0)
+    {
+        std::cout << "[-] at least one producer and one consumer needed" << std::endl;
+        return 1;
+    }
+
+    ml_lib::MpmcQueue<unsigned long long> queue(capacity);
+
+    unsigned long long num_items = num_items_per_producer * num_producers;
+
+    // pass 1: Push with backpressure, nothing may get lost
+    {
+        std::atomic<unsigned long long> popped_sum(0);
+        std::atomic<unsigned long long> num_popped(0);
+        std::atomic<std::size_t> max_depth(0);
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (unsigned int p = 0; p < num_producers; p++)
+        {
+            threads.emplace_back([&, p]()
+                                 {
+                                     for (unsigned long long i = 0; i < num_items_per_producer; i++)
+                                         queue.Push(1 + p * num_items_per_producer + i);
+                                 });
+        }
+        for (unsigned int c = 0; c < num_consumers; c++)
+        {
+            threads.emplace_back([&]()
+                                 {
+                                     unsigned long long sum = 0;
+                                     unsigned long long value;
+
+                                     while (num_popped.load(std::memory_order_relaxed) < num_items)
+                                     {
+                                         if (!queue.TryPop(value))
+                                         {
+                                             std::this_thread::yield();
+                                             continue;
+                                         }
+
+                                         sum += value;
+                                         num_popped.fetch_add(1, std::memory_order_relaxed);
+
+                                         std::size_t depth = queue.get_depth();
+                                         std::size_t cur_max_depth = max_depth.load(std::memory_order_relaxed);
+                                         while (depth > cur_max_depth && !max_depth.compare_exchange_weak(cur_max_depth, depth))
+                                             ;
+                                     }
+
+                                     popped_sum.fetch_add(sum);
+                                 });
+        }
+
+        for (auto &thread : threads)
+            thread.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        unsigned long long expected_sum = num_items * (num_items + 1) / 2;
+
+        std::cout << "[+] push/pop: " << num_producers << " producers, " << num_consumers << " consumers, capacity " << capacity << std::endl;
+        std::cout << "    items:      " << num_popped.load() << " / " << num_items << std::endl;
+        std::cout << "    checksum:   " << (popped_sum.load() == expected_sum ? "ok" : "FAILED") << std::endl;
+        std::cout << "    throughput: " << num_items / seconds / 1e6 << " M items/s" << std::endl;
+        std::cout << "    max depth:  " << max_depth.load() << std::endl;
+
+        if (popped_sum.load() != expected_sum || queue.get_depth() != 0)
+            return 1;
+    }
+
+    // pass 2: TryPush against a single slow consumer, full queue drops items
+    {
+        std::atomic<bool> producers_done(false);
+        std::atomic<unsigned long long> num_pushed(0);
+        unsigned long long num_popped = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> producers;
+        for (unsigned int p = 0; p < num_producers; p++)
+        {
+            producers.emplace_back([&]()
+                                   {
+                                       for (unsigned long long i = 0; i < num_items_per_producer; i++)
+                                       {
+                                           if (queue.TryPush(i))
+                                               num_pushed.fetch_add(1, std::memory_order_relaxed);
+                                       }
+                                   });
+        }
+        std::thread consumer([&]()
+                             {
+                                 unsigned long long value;
+
+                                 while (!producers_done.load() || queue.get_depth() > 0)
+                                 {
+                                     if (queue.TryPop(value))
+                                         num_popped++;
+                                 }
+                             });
+
+        for (auto &producer : producers)
+            producer.join();
+        producers_done.store(true);
+        consumer.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "[+] try push: " << num_producers << " producers, 1 consumer" << std::endl;
+        std::cout << "    pushed:     " << num_pushed.load() << ", popped: " << num_popped << ", dropped: " << queue.get_num_drops() << std::endl;
+        std::cout << "    consistent: " << (num_pushed.load() == num_popped && num_pushed.load() + queue.get_num_drops() == num_items ? "ok" : "FAILED") << std::endl;
+        std::cout << "    throughput: " << num_items / seconds / 1e6 << " M attempts/s" << std::endl;
+
+        if (num_pushed.load() != num_popped || num_pushed.load() + queue.get_num_drops() != num_items)
+            return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
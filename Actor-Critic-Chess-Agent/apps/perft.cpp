@@ -0,0 +1,186 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include "chess_lib/chess.h"
+
+// move generation correctness and speed harness
+// usage: perft [--depth N] [--threads N]                       reference suite up to depth N (default 3)
+//        perft --fen "<fen>" [--depth N] [--threads N] [--divide] single position, divide prints every root move
+// leaf nodes of the root moves are counted on separate threads
+struct PerftPosition
+{
+    std::string name;
+    std::string fen;
+    std::vector<unsigned long long> nodes; // nodes[i]: reference count at depth i + 1
+};
+
+// reference counts from the chess programming wiki
+const std::array<PerftPosition, 6> cPerftPositions = {{
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603, 193690690}},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238, 674624, 11030083}},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333, 15833292}},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487, 89941194}},
+    {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+     {46, 2079, 89890, 3894594, 164075551}},
+}};
+
+// the board is changed in place and restored before returning
+unsigned long long Perft(chess::Board &board, const unsigned int &depth)
+{
+    chess::MoveList legal_moves = board.GenerateLegalMoves();
+
+    // bulk counting, the legal moves of the last ply are already known
+    if (depth <= 1)
+        return depth == 0 ? 1 : legal_moves.size();
+
+    unsigned long long nodes = 0;
+    for (const chess::Move &move : legal_moves)
+    {
+        chess::Board::UndoInfo undo_info = board.MakeMove(move);
+        nodes += Perft(board, depth - 1);
+        board.UnmakeMove(undo_info);
+    }
+
+    return nodes;
+}
+
+// leaf nodes below every root move
+std::vector<unsigned long long> Divide(const chess::Board &root, const unsigned int &depth, const unsigned int &num_threads)
+{
+    chess::MoveList root_moves = root.GenerateLegalMoves();
+    std::vector<unsigned long long> root_move_nodes(root_moves.size(), 0);
+
+    if (depth == 0)
+        return root_move_nodes;
+
+    std::atomic<unsigned int> next_root_move(0);
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < std::min<std::size_t>(num_threads, root_moves.size()); t++)
+    {
+        threads.emplace_back([&]()
+                             {
+                                 // one board per thread
+                                 chess::Board board = root;
+
+                                 for (unsigned int i = next_root_move++; i < root_moves.size(); i = next_root_move++)
+                                 {
+                                     chess::Board::UndoInfo undo_info = board.MakeMove(root_moves[i]);
+                                     root_move_nodes[i] = Perft(board, depth - 1);
+                                     board.UnmakeMove(undo_info);
+                                 }
+                             });
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    return root_move_nodes;
+}
+
+unsigned long long TimedPerft(const chess::Board &board, const unsigned int &depth, const unsigned int &num_threads, double &seconds,
+                              const bool &divide)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned long long> root_move_nodes = Divide(board, depth, num_threads);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    unsigned long long nodes = depth == 0 ? 1 : 0;
+    for (const unsigned long long &n : root_move_nodes)
+        nodes += n;
+
+    if (divide)
+    {
+        chess::MoveList root_moves = board.GenerateLegalMoves();
+        for (unsigned int i = 0; i < root_moves.size(); i++)
+            std::cout << root_moves[i].ToString() << ": " << root_move_nodes[i] << std::endl;
+
+        std::cout << std::endl;
+    }
+
+    return nodes;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int depth = 0;
+    unsigned int num_threads = std::max(1U, std::thread::hardware_concurrency());
+    std::string fen;
+    bool divide = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if (option == "--divide")
+            divide = true;
+        else if (option == "--depth" && i + 1 < argc)
+            depth = std::stoul(argv[++i]);
+        else if (option == "--threads" && i + 1 < argc)
+            num_threads = std::max(1UL, std::stoul(argv[++i]));
+        else if (option == "--fen" && i + 1 < argc)
+            fen = argv[++i];
+        else
+        {
+            std::cout << "usage: perft [--fen \"<fen>\"] [--depth N] [--threads N] [--divide]" << std::endl;
+            return 1;
+        }
+    }
+
+    // single position
+    if (!fen.empty())
+    {
+        chess::Board board = chess::Board::FromFen(fen);
+
+        double seconds;
+        unsigned long long nodes = TimedPerft(board, depth == 0 ? 1 : depth, num_threads, seconds, divide);
+
+        std::cout << "nodes: " << nodes << std::endl;
+        std::cout << "time:  " << seconds << " s, " << nodes / seconds / 1e6 << " M nodes/s" << std::endl;
+
+        return 0;
+    }
+
+    // reference suite
+    unsigned int max_depth = depth == 0 ? 3 : depth;
+    bool all_passed = true;
+    unsigned long long total_nodes = 0;
+    double total_seconds = 0.;
+
+    for (const PerftPosition &position : cPerftPositions)
+    {
+        chess::Board board = chess::Board::FromFen(position.fen);
+
+        for (unsigned int d = 1; d <= std::min<std::size_t>(max_depth, position.nodes.size()); d++)
+        {
+            double seconds;
+            unsigned long long nodes = TimedPerft(board, d, num_threads, seconds, divide && d == max_depth);
+            bool passed = nodes == position.nodes[d - 1];
+
+            all_passed = all_passed && passed;
+            total_nodes += nodes;
+            total_seconds += seconds;
+
+            std::cout << (passed ? "[+] " : "[-] ") << position.name << " depth " << d << ": "
+                      << nodes << " / " << position.nodes[d - 1] << " nodes, "
+                      << nodes / seconds / 1e6 << " M nodes/s" << std::endl;
+        }
+    }
+
+    std::cout << "total: " << total_nodes << " nodes in " << total_seconds << " s, "
+              << total_nodes / total_seconds / 1e6 << " M nodes/s" << std::endl;
+
+    return all_passed ? 0 : 1;
+}
\ No newline at end of file
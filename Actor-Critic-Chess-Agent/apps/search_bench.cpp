@@ -0,0 +1,105 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "chess_lib/chess.h"
+#include "chess_lib/search.h"
+#include "chess_lib/transposition_table.h"
+
+// search speed harness, searches every position for the same time budget with the material evaluation
+// usage: search_bench [--movetime MS] [--threads N] [--hash MB]                 bench suite
+//        search_bench --fen "<fen>" [--movetime MS] [--threads N] [--hash MB]  single position, prints every depth
+struct BenchPosition
+{
+    std::string name;
+    std::string fen;
+};
+
+const std::array<BenchPosition, 6> cBenchPositions = {{
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+    {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"},
+}};
+
+void PrintReport(const chess::SearchReport &report)
+{
+    std::cout << "depth " << report.depth << ", score " << report.score << ", "
+              << report.nodes << " nodes, " << report.nodes_per_second / 1e6 << " M nodes/s, "
+              << "hashfull " << report.hashfull << ", pv";
+
+    for (const chess::Move &move : report.pv)
+        std::cout << " " << move.ToString();
+
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int movetime_ms = 1000;
+    unsigned int num_threads = std::max(1U, std::thread::hardware_concurrency());
+    unsigned int hash_mb = 64;
+    std::string fen;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if (option == "--movetime" && i + 1 < argc)
+            movetime_ms = std::max(1UL, std::stoul(argv[++i]));
+        else if (option == "--threads" && i + 1 < argc)
+            num_threads = std::max(1UL, std::stoul(argv[++i]));
+        else if (option == "--hash" && i + 1 < argc)
+            hash_mb = std::max(1UL, std::stoul(argv[++i]));
+        else if (option == "--fen" && i + 1 < argc)
+            fen = argv[++i];
+        else
+        {
+            std::cout << "usage: search_bench [--fen \"<fen>\"] [--movetime MS] [--threads N] [--hash MB]" << std::endl;
+            return 1;
+        }
+    }
+
+    chess::TranspositionTable transposition_table(hash_mb);
+    chess::Search search(transposition_table, num_threads);
+
+    chess::SearchLimits limits;
+    limits.movetime = std::chrono::milliseconds(movetime_ms);
+
+    std::cout << num_threads << " threads, " << movetime_ms << " ms per position, "
+              << transposition_table.get_size_bytes() / (1024 * 1024) << " MB hash" << std::endl;
+
+    // single position
+    if (!fen.empty())
+    {
+        search.Run(chess::Board::FromFen(fen), {}, limits, PrintReport);
+        return 0;
+    }
+
+    // bench suite, every position starts with an empty table
+    unsigned long long total_nodes = 0;
+    double total_seconds = 0.;
+
+    for (const BenchPosition &position : cBenchPositions)
+    {
+        transposition_table.Clear();
+        chess::SearchReport report = search.Run(chess::Board::FromFen(position.fen), {}, limits);
+
+        total_nodes += report.nodes;
+        total_seconds += report.seconds;
+
+        std::cout << position.name << ": ";
+        PrintReport(report);
+    }
+
+    std::cout << "total: " << total_nodes << " nodes in " << total_seconds << " s, "
+              << total_nodes / total_seconds / 1e6 << " M nodes/s" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
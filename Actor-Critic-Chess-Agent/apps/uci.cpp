@@ -0,0 +1,39 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <unistd.h>
+
+#include "ml_lib/model.h"
+#include "ml_lib/checkpoint.h"
+
+#include "actor-critic-chess-agent/environment.h"
+
+int main(int argc, char** argv) {
+    // usage: uci [checkpoint_path]
+    // without a checkpoint at checkpoint_path (default: actor_model.ckpt, as written by main) the engine searches without actor
+    std::string checkpoint_path = argc > 1 ? argv[1] : "actor_model.ckpt";
+
+    // same actor as in main
+    ml_lib::layer_type::Linear actor_l1(2048, 1024, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+    ml_lib::layer_type::Linear actor_l2(1024, 1024, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+    ml_lib::layer_type::Linear actor_l3(1024, 1024, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+    std::vector<ml_lib::LayerBase*> actor_model = {&actor_l1, &actor_l2, &actor_l3};
+
+    // stdout belongs to the protocol, thus problems go to stderr
+    if(access(checkpoint_path.c_str(), F_OK) == 0) {
+        try {
+            ml_lib::checkpoint::Load(checkpoint_path, actor_model);
+        } catch(const std::exception& e) {
+            std::cerr << "[-] failed to load " << checkpoint_path << ": " << e.what() << std::endl;
+            actor_model.clear();
+        }
+    } else {
+        actor_model.clear();
+    }
+
+    chess_agent::UciEngine engine(actor_model);
+    engine.Run(std::cin, std::cout);
+
+    return 0;
+}
\ No newline at end of file
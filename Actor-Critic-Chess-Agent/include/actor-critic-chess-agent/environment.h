@@ -5,35 +5,66 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <memory>
+#include <deque>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include <sys/types.h>
 
 #include "ml_lib/tensor.h"
+#include "ml_lib/sparse_tensor.h"
 #include "ml_lib/model.h"
 #include "ml_lib/replay_memory.h"
+#include "ml_lib/accumulator.h"
+#include "ml_lib/shared_memory.h"
 
 #include "chess_lib/chess.h"
+#include "chess_lib/search.h"
+#include "chess_lib/transposition_table.h"
 
 namespace chess_agent
 {
     extern ml_lib::Tensor ActorFeedForward(const ml_lib::Tensor& board_state, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model);
+    extern ml_lib::Tensor ActorFeedForward(const ml_lib::SparseTensor& board_state, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model);
+    extern ml_lib::Tensor ActorFeedForward(const ml_lib::Accumulator& board_state_accumulator, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model);
+    extern ml_lib::Tensor ActorFeedForwardFromFirstLayer(const ml_lib::Tensor& first_layer_out, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model);
+
+    extern ml_lib::Tensor CriticFeedForward(const ml_lib::SparseTensor& board_state, const ml_lib::Tensor& action_prop_distr, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> critic_model);
 
     extern void train(const int& epochs, std::vector<ml_lib::LayerBase*>& actor_model);
     extern void test(std::vector<ml_lib::LayerBase*> actor_model);
 
+    // single threaded training run with a fixed seed, reports throughput and the time spent per phase
+    // results are also written as json to output_path
+    extern void benchmark(const unsigned int& num_games, const unsigned int& max_moves_per_game, const unsigned int& seed, std::vector<ml_lib::LayerBase*>& actor_model, const std::string& output_path);
+
     class Replay
     {
     public:
         Replay();
-        Replay(const ml_lib::Tensor &state,
-               const ml_lib::Tensor &next_state,
+        Replay(const ml_lib::SparseTensor &state,
+               const ml_lib::SparseTensor &next_state,
                const ml_lib::Tensor &action_prop_distr,
                const ml_lib::Tensor &action_space,
                const ml_lib::Tensor &return_);
         
         static Replay Concatenate(const Replay &a, const Replay &b);
 
-        ml_lib::Tensor get_state() const;
-        ml_lib::Tensor get_next_state() const;
+        // compact byte encoding (active indices only) for handing replays to other processes
+        void Serialize(std::vector<unsigned char> &bytes) const;
+        static Replay Deserialize(const unsigned char *&bytes);
+
+        ml_lib::SparseTensor get_state() const;
+        ml_lib::SparseTensor get_next_state() const;
 
         ml_lib::Tensor get_action() const;
         ml_lib::Tensor get_action_space() const;
@@ -42,8 +73,8 @@ namespace chess_agent
         void set_return(const ml_lib::Tensor &new_return);
 
     private:
-        ml_lib::Tensor m_state;
-        ml_lib::Tensor m_next_state;
+        ml_lib::SparseTensor m_state;
+        ml_lib::SparseTensor m_next_state;
 
         ml_lib::Tensor m_action;
         ml_lib::Tensor m_action_space;
@@ -51,33 +82,257 @@ namespace chess_agent
         ml_lib::Tensor m_return;
     };
 
+    // read-only copy of the actor
+    // the detached layers carry no autodiff dependencies, thus they can be used by several threads at once
+    class ActorSnapshot
+    {
+    public:
+        static std::shared_ptr<const ActorSnapshot> Make(const std::vector<ml_lib::LayerBase*> &actor_model);
+
+        std::vector<ml_lib::LayerBase*> get_model() const;
+        const ml_lib::layer_type::Linear *get_first_layer() const;
+
+    private:
+        ActorSnapshot() = default;
+
+        std::vector<std::unique_ptr<ml_lib::LayerBase>> m_layers;
+        const ml_lib::layer_type::Linear *m_first_layer;
+    };
+
+    // collects actor requests of concurrently played games and evaluates them in one batched forward pass
+    // a batch is run as soon as max_batchsize batch elements are queued or the oldest request waited for max_wait
+    // only requests of the same actor snapshot are batched together
+    // a single request may already hold several batch elements (e.g. from an EnvironmentBatch)
+    class InferenceService
+    {
+    public:
+        InferenceService(const unsigned int &max_batchsize, const std::chrono::microseconds &max_wait);
+        InferenceService(const InferenceService &obj) = delete;
+        ~InferenceService();
+
+        // first_layer_out shape: {1024, batchsize} (e.g. from accumulators), action_space shape: {8, 8, 16, batchsize}
+        std::future<ml_lib::Tensor> Submit(const std::shared_ptr<const ActorSnapshot> &actor_snapshot,
+                                           const ml_lib::Tensor &first_layer_out,
+                                           const ml_lib::Tensor &action_space);
+
+    private:
+        struct Request
+        {
+            std::chrono::steady_clock::time_point submit_time;
+            std::shared_ptr<const ActorSnapshot> actor_snapshot;
+            ml_lib::Tensor first_layer_out;
+            ml_lib::Tensor action_space;
+            std::promise<ml_lib::Tensor> action_prop_distr;
+        };
+
+        void Run();
+        static void RunBatch(const ActorSnapshot &actor_snapshot, std::vector<Request> &batch);
+
+        unsigned int m_max_batchsize;
+        std::chrono::microseconds m_max_wait;
+
+        std::deque<Request> m_requests;
+        unsigned int m_num_queued_batch_elements;
+        bool m_stop;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::thread m_thread;
+    };
+
     class Environment
     {
     public:
         Environment();
 
         static ml_lib::Tensor SwitchBoardStatePov(const ml_lib::Tensor &board_state);
+        static ml_lib::SparseTensor SwitchBoardStatePov(const ml_lib::SparseTensor &board_state);
 
         chess::Move ActionPropDistrToMove(const ml_lib::Tensor &action_prop_distr);
         ml_lib::Tensor MoveToActionPropDistr(const chess::Move &move);
 
         chess::Board get_board() const;
-        std::vector<chess::Move> get_legal_moves() const;
+        std::span<const chess::Move> get_legal_moves() const;
         chess::Piece::Colour get_active_player() const;
 
         bool MovePiece(const chess::Move& move);
+        // takes back the last MovePiece, linked accumulators pop the undo frame of the move
+        void UndoMove();
         void Reset();
 
+        void LinkAccumulator(ml_lib::Accumulator *accumulator, const chess::Piece::Colour &pov);
+
         ml_lib::Tensor GenerateBoardState() const;
+        ml_lib::SparseTensor GenerateSparseBoardState() const;
         ml_lib::Tensor GenerateActionSpace() const;
 
+        // write the ones of GenerateBoardState (2048 values) / GenerateActionSpace (1024 values) into zeroed memory
+        void FillBoardState(double *board_state) const;
+        void FillActionSpace(double *action_space) const;
+
         static const chess::Piece::Colour cDefaultViewPoint;
         static const chess::Piece::Colour cFirstIdPieceColour;
     private:
         static std::array<int, 32> BasicPiecePositions();
 
+        void UpdateLinkedAccumulators(const std::array<int, 32> &previous_piece_positions);
+        void RefreshLinkedAccumulators();
+
         std::array<int, 32> m_piece_positions;
+        // piece positions before every move of the current game, for UndoMove
+        std::vector<std::array<int, 32>> m_previous_piece_positions;
         chess::Game m_game;
+
+        // accumulators which follow GenerateSparseBoardState from their pov
+        std::vector<std::pair<ml_lib::Accumulator *, chess::Piece::Colour>> m_linked_accumulators;
+    };
+
+    // steps num_environments games in lockstep
+    // finished games are reset automatically, so every environment always holds a running game
+    class EnvironmentBatch
+    {
+    public:
+        // max_moves_per_game = 0: games only end by checkmate or stalemate
+        EnvironmentBatch(const unsigned int &num_environments, const unsigned int &max_moves_per_game = 0);
+
+        // board_states shape: {8, 8, 16, 2, num_environments}, action_spaces shape: {8, 8, 16, num_environments}
+        void GenerateBoardStates(ml_lib::Tensor &board_states);
+        ml_lib::SparseTensor GenerateSparseBoardStates() const;
+        void GenerateActionSpaces(ml_lib::Tensor &action_spaces);
+
+        // applies one move per environment, returns which games finished (and got reset)
+        std::vector<bool> Step(const std::vector<chess::Move> &moves);
+        void Reset();
+
+        Environment &get_environment(const unsigned int &index);
+        const Environment &get_environment(const unsigned int &index) const;
+        unsigned int get_num_environments() const;
+
+        // state of the last finished game of an environment, before it was reset
+        chess::Piece::Colour get_final_active_player(const unsigned int &index) const;
+        ml_lib::SparseTensor get_final_board_state(const unsigned int &index) const;
+
+    private:
+        std::vector<Environment> m_environments;
+
+        unsigned int m_max_moves_per_game;
+        std::vector<unsigned int> m_num_moves;
+
+        std::vector<chess::Piece::Colour> m_final_active_players;
+        std::vector<ml_lib::SparseTensor> m_final_board_states;
+
+        // reused for every Generate call
+        std::vector<double> m_board_state_values;
+        std::vector<double> m_action_space_values;
+    };
+
+    // steps num_games games in lockstep until start_game refuses to start another game
+    // latest_actor_snapshot is polled between two steps, every finished game (with its returns set) is handed to finish_game
+    extern void SelfPlay(const unsigned int &num_games,
+                         const unsigned int &seed,
+                         const int &epochs,
+                         std::atomic<int> &t,
+                         InferenceService &inference_service,
+                         const std::function<std::shared_ptr<const ActorSnapshot>()> &latest_actor_snapshot,
+                         const std::function<bool()> &start_game,
+                         const std::function<void(std::vector<Replay> &&)> &finish_game);
+
+    // learner side of multi-process self-play
+    // every actor process runs "main --self-play-actor <shm name> <actor id>" and plays games with SelfPlay
+    // trajectories come back through a shared memory ring, actor weights go out through a seqlock protected snapshot
+    // crashed actors are restarted, the games they had started are played again
+    class SelfPlayProcesses
+    {
+    public:
+        static const unsigned int cMaxProcesses = 64;
+
+        SelfPlayProcesses(const unsigned int &num_processes,
+                          const int &epochs,
+                          const std::vector<ml_lib::LayerBase *> &actor_model,
+                          const unsigned int &games_per_process,
+                          const unsigned int &seed,
+                          const unsigned int &inference_max_batchsize,
+                          const std::chrono::microseconds &inference_max_wait,
+                          const std::size_t &trajectory_ring_capacity,
+                          const std::size_t &trajectory_slot_size,
+                          const bool &pin_to_numa_nodes);
+        SelfPlayProcesses(const SelfPlayProcesses &obj) = delete;
+        ~SelfPlayProcesses();
+
+        // waits for the next finished game of any actor
+        std::vector<Replay> PopTrajectory();
+        void PublishWeights(const std::vector<ml_lib::LayerBase *> &actor_model);
+
+    private:
+        void Spawn(const unsigned int &actor_id);
+        void SuperviseProcesses();
+
+        ml_lib::shared_memory::Region m_region;
+        ml_lib::shared_memory::Seqlock m_weights;
+        ml_lib::shared_memory::Ring m_trajectories;
+
+        std::vector<pid_t> m_pids;
+        std::vector<double> m_weight_values;
+        std::vector<unsigned char> m_message;
+    };
+
+    // actor side, runs until the learner has enough games or stops
+    extern void RunSelfPlayProcess(const std::string &shm_name, const unsigned int &actor_id, const std::vector<ml_lib::LayerBase *> &actor_model);
+
+    // chess engine speaking the UCI protocol, the moves are found by chess::Search
+    // with an actor the greedy actor move is searched first at the root, thus it is played unless the search finds a
+    // better one, this only works for games from the start position (the actor needs the piece ids of the environment)
+    // go searches on its own thread, thus stop and isready are answered while searching
+    class UciEngine
+    {
+    public:
+        static constexpr std::size_t cDefaultHashMb = 64;
+        static constexpr unsigned int cDefaultThreads = 1;
+
+        // an empty actor_model searches without actor
+        UciEngine(const std::vector<ml_lib::LayerBase *> &actor_model);
+        UciEngine(const UciEngine &obj) = delete;
+        ~UciEngine();
+
+        // until "quit" or the end of input
+        void Run(std::istream &input, std::ostream &output);
+
+    private:
+        void SetOption(std::istringstream &command);
+        void SetPosition(std::istringstream &command);
+        void Go(std::istringstream &command);
+        void StopSearch();
+
+        // a move in coordinate notation, Move() if it is not legal on m_board
+        chess::Move ParseMove(const std::string &move_string) const;
+        // Move() without actor or if the environment does not follow the game
+        chess::Move ActorMove();
+        // thinking time for one move out of the remaining time of the game
+        static std::chrono::milliseconds AllocateTime(const long long &remaining_ms, const long long &increment_ms, const int &moves_to_go);
+
+        void Send(const std::string &line);
+        void SendReport(const chess::SearchReport &report);
+
+        std::vector<ml_lib::LayerBase *> m_actor_model;
+
+        std::size_t m_hash_mb;
+        unsigned int m_num_threads;
+        std::unique_ptr<chess::TranspositionTable> m_transposition_table;
+        std::unique_ptr<chess::Search> m_search;
+
+        chess::Board m_board;
+        // keys of the positions before m_board, for repetition detection
+        std::vector<chess::zobrist::Key> m_position_keys;
+        Environment m_environment;
+        bool m_environment_follows_game;
+
+        std::thread m_search_thread;
+        std::atomic<bool> m_searching;
+        // "go infinite" only answers with a best move after "stop"
+        std::atomic<bool> m_stop_requested;
+
+        std::ostream *m_output;
+        std::mutex m_output_mutex;
     };
 
 } // namespace chess_agent
@@ -0,0 +1,155 @@
+#ifndef CHESS_BITBOARD_HEADER_GUARD
+#define CHESS_BITBOARD_HEADER_GUARD
+
+#include <cstdint>
+#include <array>
+#include <bit>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace chess
+{
+    namespace bitboard
+    {
+        // bit i stands for field i (a1 = 0, h1 = 7, a8 = 56)
+        typedef std::uint64_t Bitboard;
+
+        constexpr Bitboard cEmpty = 0ULL;
+        constexpr Bitboard cFileA = 0x0101010101010101ULL;
+        constexpr Bitboard cFileH = cFileA << 7;
+        constexpr Bitboard cRank1 = 0xFFULL;
+        constexpr Bitboard cRank2 = cRank1 << 8;
+        constexpr Bitboard cRank7 = cRank1 << 48;
+        constexpr Bitboard cRank8 = cRank1 << 56;
+
+        constexpr Bitboard FieldBitboard(const int &field)
+        {
+            return 1ULL << field;
+        }
+        constexpr int Count(const Bitboard &bitboard)
+        {
+            return std::popcount(bitboard);
+        }
+        constexpr int LowestField(const Bitboard &bitboard)
+        {
+            return std::countr_zero(bitboard);
+        }
+        constexpr int PopLowestField(Bitboard &bitboard)
+        {
+            int field = std::countr_zero(bitboard);
+            bitboard &= bitboard - 1;
+
+            return field;
+        }
+
+        // the field dx files and dy ranks away, -1 if it leaves the board
+        constexpr int Offset(const int &field, const int &dx, const int &dy)
+        {
+            int x = field % 8 + dx;
+            int y = field / 8 + dy;
+
+            return (x < 0 || x >= 8 || y < 0 || y >= 8) ? -1 : x + y * 8;
+        }
+
+        template <std::size_t N>
+        constexpr std::array<Bitboard, 64> GenerateLeaperAttacks(const std::array<std::array<int, 2>, N> &steps)
+        {
+            std::array<Bitboard, 64> attacks = {};
+
+            for (int field = 0; field < 64; field++)
+                for (const auto &[dx, dy] : steps)
+                    if (Offset(field, dx, dy) >= 0)
+                        attacks[field] |= FieldBitboard(Offset(field, dx, dy));
+
+            return attacks;
+        }
+
+        inline constexpr std::array<Bitboard, 64> cKnightAttacks = GenerateLeaperAttacks<8>({{{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}});
+        inline constexpr std::array<Bitboard, 64> cKingAttacks = GenerateLeaperAttacks<8>({{{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}}});
+
+        // [colour][field], white pawns advance towards rank 8
+        inline constexpr std::array<std::array<Bitboard, 64>, 2> cPawnAttacks = {GenerateLeaperAttacks<2>({{{-1, 1}, {1, 1}}}),
+                                                                                 GenerateLeaperAttacks<2>({{{-1, -1}, {1, -1}}})};
+
+        // attacked fields in the given directions, every ray stops at (and includes) the first occupied field
+        // only used to fill the attack tables, see RookAttacks and BishopAttacks
+        constexpr Bitboard SlidingAttacks(const int &field, const Bitboard &occupancy, const std::array<std::array<int, 2>, 4> &directions)
+        {
+            Bitboard attacks = cEmpty;
+
+            for (const auto &[dx, dy] : directions)
+            {
+                for (int target = Offset(field, dx, dy); target >= 0; target = Offset(target, dx, dy))
+                {
+                    attacks |= FieldBitboard(target);
+
+                    if (occupancy & FieldBitboard(target))
+                        break;
+                }
+            }
+
+            return attacks;
+        }
+
+        constexpr std::array<std::array<int, 2>, 4> cRookDirections = {{{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
+        constexpr std::array<std::array<int, 2>, 4> cBishopDirections = {{{1, 1}, {-1, 1}, {1, -1}, {-1, -1}}};
+
+        // magic bitboards: the relevant occupancy of a field (its rays without the board edge) times the magic number
+        // of the field maps every occupancy to its own slot of a precomputed attack table
+        // with BMI2 the slot is the extracted relevant occupancy (pext) instead
+        struct Magic
+        {
+            Bitboard mask;
+            Bitboard magic;
+            const Bitboard *attacks;
+            unsigned int shift;
+        };
+
+        // filled during static initialization of chess_bitboard.cpp
+        // thus they must not be used by static initializers of other translation units
+        extern const std::array<Magic, 64> cRookMagics;
+        extern const std::array<Magic, 64> cBishopMagics;
+
+        inline unsigned int MagicIndex(const Magic &magic, const Bitboard &occupancy)
+        {
+#if defined(__BMI2__)
+            return _pext_u64(occupancy, magic.mask);
+#else
+            return ((occupancy & magic.mask) * magic.magic) >> magic.shift;
+#endif
+        }
+
+        inline Bitboard RookAttacks(const int &field, const Bitboard &occupancy)
+        {
+            const Magic &magic = cRookMagics[field];
+            return magic.attacks[MagicIndex(magic, occupancy)];
+        }
+        inline Bitboard BishopAttacks(const int &field, const Bitboard &occupancy)
+        {
+            const Magic &magic = cBishopMagics[field];
+            return magic.attacks[MagicIndex(magic, occupancy)];
+        }
+        inline Bitboard QueenAttacks(const int &field, const Bitboard &occupancy)
+        {
+            return RookAttacks(field, occupancy) | BishopAttacks(field, occupancy);
+        }
+
+        // [from][to], empty if the fields share neither a rank, file nor diagonal
+        // like the magics filled during static initialization of chess_bitboard.cpp
+        extern const std::array<std::array<Bitboard, 64>, 64> cBetween; // fields strictly between from and to
+        extern const std::array<std::array<Bitboard, 64>, 64> cLine;    // the whole line through from and to
+
+        inline Bitboard Between(const int &from, const int &to)
+        {
+            return cBetween[from][to];
+        }
+        inline Bitboard Line(const int &from, const int &to)
+        {
+            return cLine[from][to];
+        }
+    } // namespace bitboard
+} // namespace chess
+
+#endif // !CHESS_BITBOARD_HEADER_GUARD
\ No newline at end of file
@@ -5,46 +5,31 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <string_view>
+#include <span>
 #include <iostream>
 
+#include "bitboard.h"
+#include "zobrist.h"
+
 namespace chess
 {
     class Board;
-    class Piece;
     class Game;
+    class MoveList;
 
-    struct Move
-    {
-    public:
-        Move(const std::string& from, const std::string& to);
-        Move(const int &from = 0, const int &to = 0);
-        bool operator==(const Move &other) const;
-
-        bool LeavesBoardBoundaries() const;
-        bool isStraightSlide() const;
-        bool isDiagonalSlide() const;
-        bool isCapture(const Board &board) const;
-
-        bool isQueensideCastling(const Piece &moving_piece) const;
-        bool isKingsideCastling(const Piece &moving_piece) const;
-        bool isEnpassant(const Piece &moving_piece, const Board &board) const;
-        bool isPawnPromotion(const Piece &moving_piece) const;
-
-        int m_from;
-        int m_to;
-    };
-
+    // colour and type packed into one byte, everything else comes from the tables indexed by them
     class Piece
     {
     public:
-        enum class Colour
+        enum class Colour : unsigned char
         {
             White,
             Black,
             None
         };
 
-        enum class Type
+        enum class Type : unsigned char
         {
             Empty,
             King,
@@ -63,83 +48,341 @@ namespace chess
         static Piece Rook(const Colour &colour);
         static Piece Pawn(const Colour &colour);
 
-        Piece();
+        // material worth per Type
+        static constexpr std::array<int, 7> cWorth = {0, 0, 9, 3, 3, 5, 1};
+        // [colour][type], white pieces are drawn filled
+        static constexpr std::array<std::array<const char *, 7>, 3> cGlyphs = {{{" ", "♚", "♛", "♝", "♞", "♜", "♟︎"},
+                                                                                {" ", "♔", "♕", "♗", "♘", "♖", "♙"},
+                                                                                {" ", " ", " ", " ", " ", " ", " "}}};
 
+        constexpr Piece() : Piece(Type::Empty, Colour::None)
+        {
+        }
+        constexpr Piece(const Piece::Type &type, const Colour &colour) : m_data((unsigned char)((unsigned char)type | (unsigned char)colour << 3))
+        {
+        }
+
+        // moves of the piece standing on starting_field of board
         void GeneratePseudoLegalMoves(const unsigned int &starting_field,
-                                      std::vector<Move> &pseudo_legal_moves,
+                                      MoveList &pseudo_legal_moves,
                                       const Board &board) const;
 
-        void IncrementStepsTaken();
+        constexpr Colour get_colour() const
+        {
+            return (Colour)(m_data >> 3);
+        }
+        constexpr Piece::Type get_type() const
+        {
+            return (Piece::Type)(m_data & 7);
+        }
+        constexpr void reset_type(const Piece::Type &new_type)
+        {
+            m_data = (unsigned char)((m_data & ~7) | (unsigned char)new_type);
+        }
+        constexpr unsigned int get_worth() const
+        {
+            return cWorth[(int)get_type()];
+        }
+        constexpr const char *get_glyph() const
+        {
+            return cGlyphs[(int)get_colour()][(int)get_type()];
+        }
+
+    private:
+        // type in the lower three bits, colour above
+        unsigned char m_data;
+    };
+
+    static_assert(sizeof(Piece) == 1, "a piece is packed into one byte");
+
+    // 6 bits from, 6 bits to and 4 flag bits, set by the move generator
+    // moves created from fields only (user input, agent actions) carry no flags, Game::MovePiece matches them by fields
+    struct Move
+    {
+    public:
+        static constexpr unsigned int cQuiet = 0;
+        static constexpr unsigned int cDoublePawnPush = 1;
+        static constexpr unsigned int cKingsideCastling = 2;
+        static constexpr unsigned int cQueensideCastling = 3;
+        static constexpr unsigned int cCapture = 4;
+        static constexpr unsigned int cEnPassant = 5;
+        // the lower two bits select knight, bishop, rook or queen, the capture bit may be set as well
+        static constexpr unsigned int cPromotion = 8;
+
+        Move(const std::string& from, const std::string& to);
+        Move(const int &from = 0, const int &to = 0, const unsigned int &flags = cQuiet)
+            : m_data((std::uint16_t)(from | to << 6 | flags << 12))
+        {
+        }
+        bool operator==(const Move &other) const
+        {
+            return m_data == other.m_data;
+        }
+
+        int get_from() const
+        {
+            return m_data & 63;
+        }
+        int get_to() const
+        {
+            return m_data >> 6 & 63;
+        }
+        unsigned int get_flags() const
+        {
+            return m_data >> 12;
+        }
+
+        bool isCapture() const
+        {
+            return get_flags() & cCapture;
+        }
+        bool isKingsideCastling() const
+        {
+            return get_flags() == cKingsideCastling;
+        }
+        bool isQueensideCastling() const
+        {
+            return get_flags() == cQueensideCastling;
+        }
+        bool isEnpassant() const
+        {
+            return get_flags() == cEnPassant;
+        }
+        bool isPawnPromotion() const
+        {
+            return get_flags() & cPromotion;
+        }
+        // Piece::Type::Empty if the move is no promotion
+        Piece::Type get_promotion_type() const;
+        // coordinate notation as used by UCI, e.g. "e2e4" or "e7e8q"
+        std::string ToString() const;
+
+        bool isStraightSlide() const;
+        bool isDiagonalSlide() const;
+
+        // all 16 bits, e.g. for transposition table entries
+        std::uint16_t get_data() const
+        {
+            return m_data;
+        }
+        static Move FromData(const std::uint16_t &data);
+
+    private:
+        std::uint16_t m_data;
+    };
+
+    static_assert(sizeof(Move) == 2, "moves are packed into 16 bits");
 
-        Colour get_colour() const;
-        Piece::Type get_type() const;
-        void reset_type(const Piece::Type &new_type);
-        unsigned int get_worth() const;
+    // fixed capacity list of moves, lives on the stack thus move generation does not allocate
+    // no legal chess position has more than 218 moves
+    class MoveList
+    {
+    public:
+        static const unsigned int cCapacity = 256;
+
+        MoveList() : m_size(0)
+        {
+        }
+
+        void push_back(const Move &m)
+        {
+            m_moves[m_size++] = m;
+        }
+        void clear()
+        {
+            m_size = 0;
+        }
+
+        unsigned int size() const
+        {
+            return m_size;
+        }
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        Move &operator[](const unsigned int &i)
+        {
+            return m_moves[i];
+        }
+        const Move &operator[](const unsigned int &i) const
+        {
+            return m_moves[i];
+        }
+
+        Move *begin()
+        {
+            return m_moves.data();
+        }
+        Move *end()
+        {
+            return m_moves.data() + m_size;
+        }
+        const Move *begin() const
+        {
+            return m_moves.data();
+        }
+        const Move *end() const
+        {
+            return m_moves.data() + m_size;
+        }
 
     private:
-        Piece(const Piece::Type &type, const unsigned int &worth, const Colour &colour);
-
-        void ContinueGeneratingSlidingMoves(const Move &first_move,
-                                            std::vector<Move> &pseudo_legal_moves,
-                                            const Board &board) const;
-
-        void GenerateKingMoves(const unsigned int &starting_field, std::vector<Move> &pseudo_legal_moves, const Board &board) const;
-        void GenerateQueenMoves(const unsigned int &starting_field, std::vector<Move> &pseudo_legal_moves, const Board &board) const;
-        void GenerateBishopMoves(const unsigned int &starting_field, std::vector<Move> &pseudo_legal_moves, const Board &board) const;
-        void GenerateKnightMoves(const unsigned int &starting_field, std::vector<Move> &pseudo_legal_moves, const Board &board) const;
-        void GenerateRookMoves(const unsigned int &starting_field, std::vector<Move> &pseudo_legal_moves, const Board &board) const;
-        void GeneratePawnMoves(const unsigned int &starting_field, std::vector<Move> &pseudo_legal_moves, const Board &board) const;
-
-        bool isCastlingPossible(const Move &move_to_rook, const Board &board) const;
-        static bool isKnightMove(const Move& move);
-
-        Colour m_colour;
-        unsigned int m_steps_taken;
-        Piece::Type m_type;
-        unsigned int m_worth;
+        // in a union the moves are left uninitialized, only the first m_size are ever read
+        union
+        {
+            std::array<Move, cCapacity> m_moves;
+        };
+        unsigned int m_size;
     };
 
+    // 12 piece bitboards (one per colour and type) plus the occupancy of both colours
+    // castling rights, en passant field and the player to move are part of the board
     class Board
     {
     public:
         const static Piece::Colour cPlayerAtTop;
 
+        static constexpr unsigned char cWhiteKingsideCastling = 1;
+        static constexpr unsigned char cWhiteQueensideCastling = 2;
+        static constexpr unsigned char cBlackKingsideCastling = 4;
+        static constexpr unsigned char cBlackQueensideCastling = 8;
+
+        // kinds of moves for GenerateLegalMoves, captures include en passant and promotions
+        static constexpr unsigned int cCaptureMoves = 1;
+        static constexpr unsigned int cQuietMoves = 2;
+        static constexpr unsigned int cAllMoves = cCaptureMoves | cQuietMoves;
+
+        // everything MakeMove changes which can not be derived from the move itself
+        struct UndoInfo
+        {
+            Move move;
+            Piece::Type moved_type;
+            Piece::Type captured_type;
+            unsigned char castling_rights;
+            signed char en_passant_field;
+            zobrist::Key key;
+        };
+
         static Board BasicSetup();
+        // parsed in place without allocating, missing trailing fields take their defaults ("w - - 0 1")
+        static Board FromFen(std::string_view fen);
+        static Board FromFen(std::string_view fen, unsigned int &halfmove_clock, unsigned int &fullmove_number);
+        std::string ToFen(const unsigned int &halfmove_clock = 0, const unsigned int &fullmove_number = 1) const;
+
+        // in place, UnmakeMove(MakeMove(m)) restores the board
+        UndoInfo MakeMove(const Move &m);
+        void UnmakeMove(const UndoInfo &undo_info);
+        // passes the turn to the opponent, for null move pruning, must not be used while in check
+        UndoInfo MakeNullMove();
+        void UnmakeNullMove(const UndoInfo &undo_info);
 
         Board MovePiece(const Move &m) const;
-        std::vector<Move> GeneratePseudoLegalMoves(const Piece::Colour &player) const;
+        MoveList GeneratePseudoLegalMoves(const Piece::Colour &player) const;
+        void GeneratePseudoLegalMoves(const unsigned int &field, MoveList &pseudo_legal_moves) const;
 
-        bool isKingUnderAttack(const Piece::Colour &king_owner, const std::vector<Move> &opponent_legal_moves) const;
+        bool isKingUnderAttack(const Piece::Colour &king_owner, const MoveList &opponent_legal_moves) const;
+        bool isFieldAttacked(const int &field, const Piece::Colour &attacker) const;
+        bool isInCheck(const Piece::Colour &king_owner) const;
+
+        // moves of the active player which do not leave its king attacked
+        // generated directly from the checking and pinning pieces, without trying the moves
+        MoveList GenerateLegalMoves() const;
+        // appends the legal moves of the given kinds of the pieces on from_fields
+        void GenerateLegalMoves(MoveList &legal_moves, const unsigned int &kinds, const bitboard::Bitboard &from_fields = ~bitboard::cEmpty) const;
+        // m has to carry the flags of the move generator, e.g. a move from a transposition table
+        bool isLegal(const Move &m) const;
 
         std::string ToString() const;
         Piece get_piece_at(const int &field_index) const;
 
+        bitboard::Bitboard get_pieces(const Piece::Colour &colour, const Piece::Type &type) const;
+        bitboard::Bitboard get_occupancy(const Piece::Colour &colour) const;
+        bitboard::Bitboard get_occupancy() const;
+
+        unsigned char get_castling_rights() const;
+        // -1 if the last move was no double pawn advance
+        int get_en_passant_field() const;
+        Piece::Colour get_active_player() const;
+        // sum of Piece::cWorth over the pieces of colour, kept up to date by every move
+        int get_material(const Piece::Colour &colour) const;
+        // zobrist key of the position, kept up to date by every move
+        zobrist::Key get_key() const;
+        // the key computed from scratch, equals get_key() unless the incremental update is broken
+        zobrist::Key ComputeKey() const;
+
     private:
-        Board(const std::array<Piece, 64> &b);
+        Board();
+
+        void PutPiece(const int &field, const Piece::Colour &colour, const Piece::Type &type);
+        void RemovePiece(const int &field, const Piece::Colour &colour, const Piece::Type &type);
+        Piece::Type get_type_at(const int &field, const Piece::Colour &colour) const;
+
+        // fields the piece on field may move to, without castling
+        bitboard::Bitboard get_move_targets(const int &field, const Piece::Colour &player, const Piece::Type &type) const;
+        void GenerateCastlingMoves(const int &field, const Piece::Colour &player, MoveList &moves) const;
+        // one move per target, flagged, promotions once per promotion piece
+        void PushMoves(const int &field, const Piece::Colour &player, const Piece::Type &type, bitboard::Bitboard targets, MoveList &moves) const;
+        // pieces of attacker which attack field if the board was occupied by occupancy
+        bitboard::Bitboard get_attackers(const int &field, const Piece::Colour &attacker, const bitboard::Bitboard &occupancy) const;
 
-        std::array<Piece, 64> m_pieces;
+        static int BitboardIndex(const Piece::Colour &colour, const Piece::Type &type);
+
+        std::array<bitboard::Bitboard, 12> m_pieces;
+        std::array<bitboard::Bitboard, 2> m_occupancy;
+        zobrist::Key m_key;
+        std::array<std::int16_t, 2> m_material;
+
+        unsigned char m_castling_rights;
+        signed char m_en_passant_field;
+        Piece::Colour m_active_player;
     };
 
+    static_assert(sizeof(Board) <= 128, "a board has to fit into two cache lines");
+
     class Game
     {
     public:
         Game();
+        static Game FromFen(std::string_view fen);
+        std::string ToFen() const;
 
         bool MovePiece(const Move &m);
+        // takes back the last MovePiece
+        void UnmakeMove();
         void Reset();
         
         Board get_board() const;
         Piece::Colour get_active_player() const;
-        std::vector<Move> get_legal_moves() const;
+        // valid until the next MovePiece or Reset
+        std::span<const Move> get_legal_moves() const;
+        zobrist::Key get_key() const;
+        // moves since the last capture or pawn move, for the fifty move rule
+        unsigned int get_halfmove_clock() const;
+        // starts at 1, incremented after every move of black
+        unsigned int get_fullmove_number() const;
 
         static Piece::Colour Opponent(const Piece::Colour &active_player);
     private:
-        std::vector<Move> GenerateLegalMoves() const;
+        Game(const Board &board, const Piece::Colour &active_player, const unsigned int &halfmove_clock, const unsigned int &fullmove_number);
+
+        MoveList GenerateLegalMoves() const;
+
+        // everything UnmakeMove needs to take back one MovePiece
+        struct UndoInfo
+        {
+            Board::UndoInfo board_undo_info;
+            unsigned int halfmove_clock;
+        };
 
         Piece::Colour m_active_player;
         Board m_board;
+        unsigned int m_halfmove_clock;
+        unsigned int m_fullmove_number;
+        std::vector<UndoInfo> m_undo_infos;
 
-        std::vector<Move> m_current_state_legal_moves;
+        MoveList m_current_state_legal_moves;
     };
 } // namespace chess
 
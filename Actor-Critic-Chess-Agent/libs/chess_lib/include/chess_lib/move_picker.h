@@ -0,0 +1,60 @@
+#ifndef CHESS_MOVE_PICKER_HEADER_GUARD
+#define CHESS_MOVE_PICKER_HEADER_GUARD
+
+#include <array>
+
+#include "chess.h"
+
+namespace chess
+{
+    // hands out the legal moves of a board one by one in the order a search wants to try them:
+    // hash move, captures (most valuable victim, least valuable attacker first), killer moves, quiet moves
+    // every stage is only generated once the moves before it are used up,
+    // thus a search cutting off early never generates the quiet moves
+    // the board must not change while the picker is in use
+    class MovePicker
+    {
+    public:
+        static const unsigned int cNumKillers = 2;
+
+        // hash_move and killers may be Move() or moves of another position, they are checked before they are returned
+        MovePicker(const Board &board, const Move &hash_move, const std::array<Move, cNumKillers> &killers);
+        // captures only, for quiescence search
+        MovePicker(const Board &board, const Move &hash_move);
+
+        // false once every move was returned
+        bool Next(Move &move);
+
+        // true while the returned moves come from the capture stages (hash move included if it is a capture)
+        bool isCaptureStage() const;
+
+    private:
+        enum class Stage
+        {
+            HashMove,
+            GenerateCaptures,
+            Captures,
+            Killers,
+            GenerateQuiets,
+            Quiets,
+            Done
+        };
+
+        // index of the best scored move not returned yet, swapped to m_index
+        unsigned int SelectBest();
+        // moves which were already returned by an earlier stage
+        bool isReturnedEarlier(const Move &move) const;
+
+        const Board &m_board;
+        Move m_hash_move;
+        std::array<Move, cNumKillers> m_killers;
+        bool m_captures_only;
+
+        Stage m_stage;
+        MoveList m_moves;
+        std::array<int, MoveList::cCapacity> m_scores;
+        unsigned int m_index;
+    };
+} // namespace chess
+
+#endif // !CHESS_MOVE_PICKER_HEADER_GUARD
\ No newline at end of file
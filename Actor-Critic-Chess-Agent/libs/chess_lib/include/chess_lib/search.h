@@ -0,0 +1,118 @@
+#ifndef CHESS_SEARCH_HEADER_GUARD
+#define CHESS_SEARCH_HEADER_GUARD
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <functional>
+
+#include "chess.h"
+#include "zobrist.h"
+#include "move_picker.h"
+#include "transposition_table.h"
+
+namespace chess
+{
+    // score of a position from the view of the player to move, in centipawns
+    // called concurrently by every search thread
+    typedef std::function<int(const Board &)> Evaluation;
+
+    // 100 per pawn of material difference
+    extern int MaterialEvaluation(const Board &board);
+
+    // a limit of 0 is no limit
+    struct SearchLimits
+    {
+        int depth = 0;
+        std::chrono::milliseconds movetime = std::chrono::milliseconds(0);
+        unsigned long long nodes = 0;
+    };
+
+    struct SearchReport
+    {
+        int depth;
+        int score;
+        std::vector<Move> pv;
+        unsigned long long nodes;
+        double seconds;
+        unsigned long long nodes_per_second;
+        // transposition table fill per thousand
+        unsigned int hashfull;
+    };
+
+    // principal variation alpha-beta search with iterative deepening, quiescence search, null move pruning and
+    // late move reductions
+    // Lazy SMP: every thread searches the same position on its own board, they only share the transposition table
+    // helper threads with odd ids search one ply deeper, thus the threads fill the table for each other
+    class Search
+    {
+    public:
+        static const int cMaxPly = 128;
+        static const int cInfinity = 32000;
+        static const int cMateScore = 31000;
+        // scores beyond are mates, cMateScore - |score| plies away from the root
+        static const int cMateBound = cMateScore - cMaxPly;
+
+        Search(TranspositionTable &transposition_table, const unsigned int &num_threads, const Evaluation &evaluation = MaterialEvaluation);
+        Search(const Search &obj) = delete;
+
+        // blocks until a limit is hit or Stop is called, report is called after every depth the main thread finished
+        // position_keys are the keys of the positions played before board, a repetition of one of them is a draw
+        // the returned report is the one of the last finished depth, its pv is empty only if board has no legal moves
+        SearchReport Run(const Board &board, const std::vector<zobrist::Key> &position_keys, const SearchLimits &limits,
+                         const std::function<void(const SearchReport &)> &report = nullptr);
+        // may be called from any thread
+        void Stop();
+
+        static bool isMateScore(const int &score);
+
+    private:
+        struct Worker
+        {
+            Worker(const unsigned int &id, const Board &board, const std::vector<zobrist::Key> &position_keys);
+
+            unsigned int id;
+            Board board;
+            // positions of the game and of the current search path
+            std::vector<zobrist::Key> keys;
+            std::array<std::array<Move, MovePicker::cNumKillers>, cMaxPly> killers;
+            std::atomic<unsigned long long> nodes;
+
+            Move root_best_move;
+            Move best_move;
+            int best_score;
+            int completed_depth;
+        };
+
+        void IterativeDeepening(Worker &worker);
+        int AlphaBeta(Worker &worker, int alpha, int beta, int depth, const int &ply, const bool &null_move_allowed);
+        int Quiescence(Worker &worker, int alpha, int beta, const int &ply);
+
+        int Evaluate(const Board &board) const;
+        bool isRepetition(const Worker &worker) const;
+        void CheckLimits(Worker &worker);
+
+        SearchReport MakeReport(const Worker &worker) const;
+        std::vector<Move> ExtractPv(const Board &board, const Move &best_move, const int &max_length) const;
+        unsigned long long get_nodes() const;
+        double get_seconds() const;
+
+        // mate scores are stored relative to the position, not to the root
+        static int ScoreToTable(const int &score, const int &ply);
+        static int ScoreFromTable(const int &score, const int &ply);
+
+        TranspositionTable &m_transposition_table;
+        unsigned int m_num_threads;
+        Evaluation m_evaluation;
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        SearchLimits m_limits;
+        std::function<void(const SearchReport &)> m_report;
+        std::chrono::steady_clock::time_point m_start;
+        std::atomic<bool> m_stop;
+    };
+} // namespace chess
+
+#endif // !CHESS_SEARCH_HEADER_GUARD
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef CHESS_TRANSPOSITION_TABLE_HEADER_GUARD
+#define CHESS_TRANSPOSITION_TABLE_HEADER_GUARD
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+
+#include "chess.h"
+#include "zobrist.h"
+
+namespace chess
+{
+    // search results by zobrist key, shared by all search threads without locks
+    // an entry is two 64 bit words, the key is stored xor-ed with the data word
+    // a probe only hits if both words belong to the same store, torn writes of concurrent threads look like a miss
+    class TranspositionTable
+    {
+    public:
+        static const std::size_t cBucketSize = 64;
+        static const std::size_t cEntriesPerBucket = 4;
+
+        // score is an upper or lower bound if the search failed low or high
+        enum class Bound : unsigned char
+        {
+            None,
+            Upper,
+            Lower,
+            Exact
+        };
+
+        struct Entry
+        {
+            Move move;
+            int score;
+            int depth;
+            Bound bound;
+        };
+
+        // the size is rounded down to a power of two number of buckets
+        // with use_huge_pages the table is backed by huge pages if the system has some reserved,
+        // transparent huge pages otherwise
+        TranspositionTable(const std::size_t &size_mb, const bool &use_huge_pages = false);
+        TranspositionTable(const TranspositionTable &obj) = delete;
+        ~TranspositionTable();
+
+        bool Probe(const zobrist::Key &key, Entry &entry) const;
+        // score has to fit into 16 bits, depth into 8 bits
+        void Store(const zobrist::Key &key, const Move &move, const int &score, const int &depth, const Bound &bound);
+
+        // entries of earlier searches are replaced first
+        void NewSearch();
+        // not thread safe
+        void Clear();
+
+        // filled entries per thousand, estimated from the first buckets
+        unsigned int Hashfull() const;
+
+        std::size_t get_size_bytes() const;
+        bool get_uses_huge_pages() const;
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t> key_xor_data;
+            std::atomic<std::uint64_t> data;
+        };
+
+        struct alignas(cBucketSize) Bucket
+        {
+            std::array<Slot, cEntriesPerBucket> slots;
+        };
+
+        static_assert(sizeof(Bucket) == cBucketSize, "a bucket has to fill exactly one cache line");
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "entries need lock-free 64 bit atomics");
+
+        // move (16 bits), score (16 bits), depth (8 bits), bound (2 bits) and age (6 bits)
+        static std::uint64_t Pack(const Move &move, const int &score, const int &depth, const Bound &bound, const unsigned int &age);
+        static Entry Unpack(const std::uint64_t &data);
+        static unsigned int get_age(const std::uint64_t &data);
+
+        Bucket *m_buckets;
+        std::size_t m_num_buckets;
+        std::size_t m_size_bytes;
+        bool m_uses_huge_pages;
+
+        std::atomic<unsigned int> m_age;
+    };
+} // namespace chess
+
+#endif // !CHESS_TRANSPOSITION_TABLE_HEADER_GUARD
\ No newline at end of file
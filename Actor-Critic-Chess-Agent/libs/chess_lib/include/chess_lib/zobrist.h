@@ -0,0 +1,58 @@
+#ifndef CHESS_ZOBRIST_HEADER_GUARD
+#define CHESS_ZOBRIST_HEADER_GUARD
+
+#include <cstdint>
+#include <array>
+
+namespace chess
+{
+    namespace zobrist
+    {
+        // a position is identified by the xor of the keys of its pieces, castling rights, en passant file and
+        // the player to move, thus every change of the position flips only the keys it touches
+        typedef std::uint64_t Key;
+
+        // splitmix64, the tables are fixed at compile time so keys are the same in every process
+        constexpr Key NextRandom(Key &state)
+        {
+            Key z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+            return z ^ (z >> 31);
+        }
+
+        struct Keys
+        {
+            std::array<std::array<Key, 64>, 12> pieces; // [colour * 6 + type - 1][field], like the piece bitboards
+            std::array<Key, 16> castling_rights;        // [castling rights]
+            std::array<Key, 8> en_passant_file;          // [file of the en passant field]
+            Key black_to_move;
+        };
+
+        constexpr Keys GenerateKeys()
+        {
+            Keys keys = {};
+            Key state = 0x5a6f627269737431ULL;
+
+            for (auto &piece_keys : keys.pieces)
+                for (Key &key : piece_keys)
+                    key = NextRandom(state);
+
+            // no castling rights must not change the key
+            for (unsigned int rights = 1; rights < 16; rights++)
+                keys.castling_rights[rights] = NextRandom(state);
+
+            for (Key &key : keys.en_passant_file)
+                key = NextRandom(state);
+
+            keys.black_to_move = NextRandom(state);
+
+            return keys;
+        }
+
+        inline constexpr Keys cKeys = GenerateKeys();
+    } // namespace zobrist
+} // namespace chess
+
+#endif // !CHESS_ZOBRIST_HEADER_GUARD
\ No newline at end of file
@@ -1,189 +1,707 @@
 #include "chess_lib/chess.h"
 
+#include <cassert>
+#include <charconv>
+
 namespace chess
 {
     const Piece::Colour Board::cPlayerAtTop = Piece::Colour::White;
 
+    namespace
+    {
+        // castling rights which are kept when a piece moves from or to a field
+        constexpr std::array<unsigned char, 64> GenerateCastlingRightsMasks()
+        {
+            std::array<unsigned char, 64> masks;
+            masks.fill(Board::cWhiteKingsideCastling | Board::cWhiteQueensideCastling |
+                       Board::cBlackKingsideCastling | Board::cBlackQueensideCastling);
+
+            masks[0] &= ~Board::cWhiteQueensideCastling;
+            masks[7] &= ~Board::cWhiteKingsideCastling;
+            masks[4] &= ~(Board::cWhiteKingsideCastling | Board::cWhiteQueensideCastling);
+            masks[56] &= ~Board::cBlackQueensideCastling;
+            masks[63] &= ~Board::cBlackKingsideCastling;
+            masks[60] &= ~(Board::cBlackKingsideCastling | Board::cBlackQueensideCastling);
+
+            return masks;
+        }
+
+        constexpr std::array<unsigned char, 64> cCastlingRightsMasks = GenerateCastlingRightsMasks();
+
+        const std::array<Piece::Type, 6> cPieceTypes = {Piece::Type::King, Piece::Type::Queen, Piece::Type::Bishop,
+                                                        Piece::Type::Knight, Piece::Type::Rook, Piece::Type::Pawn};
+
+        // the whole field has to be a decimal number
+        bool ParseFenNumber(const std::string_view &field, unsigned int &number)
+        {
+            std::from_chars_result result = std::from_chars(field.data(), field.data() + field.size(), number);
+            return result.ec == std::errc() && result.ptr == field.data() + field.size();
+        }
+    } // namespace
+
     Board Board::BasicSetup()
     {
-        std::array<Piece, 64> board_pieces;
-        board_pieces.fill(Piece::Empty());
+        static const std::array<Piece::Type, 8> cBackRank = {Piece::Type::Rook, Piece::Type::Knight, Piece::Type::Bishop, Piece::Type::Queen,
+                                                             Piece::Type::King, Piece::Type::Bishop, Piece::Type::Knight, Piece::Type::Rook};
+
+        Board board;
 
         // place white pieces
-        board_pieces[0] = Piece::Rook(Board::cPlayerAtTop);
-        board_pieces[1] = Piece::Knight(Board::cPlayerAtTop);
-        board_pieces[2] = Piece::Bishop(Board::cPlayerAtTop);
-        board_pieces[3] = Piece::Queen(Board::cPlayerAtTop);
-        board_pieces[4] = Piece::King(Board::cPlayerAtTop);
-        board_pieces[5] = Piece::Bishop(Board::cPlayerAtTop);
-        board_pieces[6] = Piece::Knight(Board::cPlayerAtTop);
-        board_pieces[7] = Piece::Rook(Board::cPlayerAtTop);
-
-        board_pieces[8] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[9] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[10] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[11] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[12] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[13] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[14] = Piece::Pawn(Board::cPlayerAtTop);
-        board_pieces[15] = Piece::Pawn(Board::cPlayerAtTop);
+        for (int x = 0; x < 8; x++)
+        {
+            board.PutPiece(x, Board::cPlayerAtTop, cBackRank[x]);
+            board.PutPiece(8 + x, Board::cPlayerAtTop, Piece::Type::Pawn);
+        }
 
         // place black pieces
         Piece::Colour player_at_bottom = Game::Opponent(Board::cPlayerAtTop);
-        board_pieces[63 - 0] = Piece::Rook(player_at_bottom);
-        board_pieces[63 - 1] = Piece::Knight(player_at_bottom);
-        board_pieces[63 - 2] = Piece::Bishop(player_at_bottom);
-        board_pieces[63 - 3] = Piece::King(player_at_bottom);
-        board_pieces[63 - 4] = Piece::Queen(player_at_bottom);
-        board_pieces[63 - 5] = Piece::Bishop(player_at_bottom);
-        board_pieces[63 - 6] = Piece::Knight(player_at_bottom);
-        board_pieces[63 - 7] = Piece::Rook(player_at_bottom);
-
-        board_pieces[63 - 8] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 9] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 10] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 11] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 12] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 13] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 14] = Piece::Pawn(player_at_bottom);
-        board_pieces[63 - 15] = Piece::Pawn(player_at_bottom);
-
-        return Board(board_pieces);
-    }
+        for (int x = 0; x < 8; x++)
+        {
+            board.PutPiece(56 + x, player_at_bottom, cBackRank[x]);
+            board.PutPiece(48 + x, player_at_bottom, Piece::Type::Pawn);
+        }
 
-    Board Board::MovePiece(const Move &m) const
+        board.m_castling_rights = cWhiteKingsideCastling | cWhiteQueensideCastling | cBlackKingsideCastling | cBlackQueensideCastling;
+        board.m_key = board.ComputeKey();
+
+        return board;
+    }
+    Board Board::FromFen(std::string_view fen)
+    {
+        unsigned int halfmove_clock, fullmove_number;
+        return FromFen(fen, halfmove_clock, fullmove_number);
+    }
+    Board Board::FromFen(std::string_view fen, unsigned int &halfmove_clock, unsigned int &fullmove_number)
     {
-        int captured_points = 0;
+        Board board;
 
-        std::array<Piece, 64> next_state_board_pieces = m_pieces;
+        // piece placement, rank 8 first
+        std::size_t i = 0;
+        int x = 0;
+        int y = 7;
+        for (; i < fen.size() && fen[i] != ' '; i++)
+        {
+            char c = fen[i];
+
+            if (c == '/')
+            {
+                if (x != 8 || y == 0)
+                    throw std::invalid_argument("fen has an invalid piece placement!");
+
+                x = 0;
+                y--;
+                continue;
+            }
+            if (c >= '1' && c <= '8')
+            {
+                x += c - '0';
+                if (x > 8)
+                    throw std::invalid_argument("fen has an invalid piece placement!");
+                continue;
+            }
+            if (x >= 8)
+                throw std::invalid_argument("fen has an invalid piece placement!");
 
-        Piece &moving_piece = next_state_board_pieces[m.m_from];
-        Piece &captured_piece = next_state_board_pieces[m.m_to];
+            Piece::Colour colour = (c >= 'A' && c <= 'Z') ? Piece::Colour::White : Piece::Colour::Black;
+            Piece::Type type;
 
-        if (m.isQueensideCastling(moving_piece))
+            switch (c | 0x20) // lower case
+            {
+            case 'k':
+                type = Piece::Type::King;
+                break;
+            case 'q':
+                type = Piece::Type::Queen;
+                break;
+            case 'b':
+                type = Piece::Type::Bishop;
+                break;
+            case 'n':
+                type = Piece::Type::Knight;
+                break;
+            case 'r':
+                type = Piece::Type::Rook;
+                break;
+            case 'p':
+                type = Piece::Type::Pawn;
+                break;
+            default:
+                throw std::invalid_argument("fen has an invalid piece placement!");
+            }
+
+            board.PutPiece(x + y * 8, colour, type);
+            x++;
+        }
+        if (x != 8 || y != 0)
+            throw std::invalid_argument("fen has an invalid piece placement!");
+
+        // the other fields are views into fen, missing trailing fields keep their defaults
+        auto next_field = [&]()
+        {
+            while (i < fen.size() && fen[i] == ' ')
+                i++;
+
+            std::size_t field_start = i;
+            while (i < fen.size() && fen[i] != ' ')
+                i++;
+
+            return fen.substr(field_start, i - field_start);
+        };
+        std::string_view active_colour = next_field();
+        std::string_view castling_rights = next_field();
+        std::string_view en_passant_field = next_field();
+        std::string_view halfmove_clock_field = next_field();
+        std::string_view fullmove_number_field = next_field();
+
+        if (active_colour == "b")
+            board.m_active_player = Piece::Colour::Black;
+        else if (!active_colour.empty() && active_colour != "w")
+            throw std::invalid_argument("fen has an invalid active colour!");
+
+        if (castling_rights != "-")
+        {
+            for (char c : castling_rights)
+            {
+                switch (c)
+                {
+                case 'K':
+                    board.m_castling_rights |= cWhiteKingsideCastling;
+                    break;
+                case 'Q':
+                    board.m_castling_rights |= cWhiteQueensideCastling;
+                    break;
+                case 'k':
+                    board.m_castling_rights |= cBlackKingsideCastling;
+                    break;
+                case 'q':
+                    board.m_castling_rights |= cBlackQueensideCastling;
+                    break;
+                default:
+                    throw std::invalid_argument("fen has invalid castling rights!");
+                }
+            }
+        }
+
+        // a castling right without king and rook on their initial fields can not be used
+        for (int field : {0, 4, 7, 56, 60, 63})
         {
-            int rook_position = m.m_from - 4;
-            int rook_target_position = m.m_from - 1;
-            Piece &rook = next_state_board_pieces[rook_position];
+            Piece::Type type = board.get_piece_at(field).get_type();
+            if (type != Piece::Type::King && type != Piece::Type::Rook)
+                board.m_castling_rights &= cCastlingRightsMasks[field];
+        }
 
-            next_state_board_pieces[rook_target_position] = rook;
-            next_state_board_pieces[rook_position] = Piece::Empty();
+        if (!en_passant_field.empty() && en_passant_field != "-")
+        {
+            if (en_passant_field.size() != 2 || en_passant_field[0] < 'a' || en_passant_field[0] > 'h' ||
+                (en_passant_field[1] != '3' && en_passant_field[1] != '6'))
+                throw std::invalid_argument("fen has an invalid en passant field!");
 
-            rook.IncrementStepsTaken();
+            board.m_en_passant_field = (signed char)((en_passant_field[0] - 'a') + (en_passant_field[1] - '1') * 8);
         }
-        else if (m.isKingsideCastling(moving_piece))
+
+        halfmove_clock = 0;
+        fullmove_number = 1;
+        if (!halfmove_clock_field.empty() && !ParseFenNumber(halfmove_clock_field, halfmove_clock))
+            throw std::invalid_argument("fen has an invalid halfmove clock!");
+        if (!fullmove_number_field.empty() && !ParseFenNumber(fullmove_number_field, fullmove_number))
+            throw std::invalid_argument("fen has an invalid fullmove number!");
+        // some writers start counting at 0
+        fullmove_number = std::max(fullmove_number, 1U);
+
+        // PutPiece already added the pieces to the key
+        if (board.m_en_passant_field >= 0)
+            board.m_key ^= zobrist::cKeys.en_passant_file[board.m_en_passant_field % 8];
+        if (board.m_active_player == Piece::Colour::Black)
+            board.m_key ^= zobrist::cKeys.black_to_move;
+        board.m_key ^= zobrist::cKeys.castling_rights[board.m_castling_rights];
+
+        assert(board.m_key == board.ComputeKey());
+
+        return board;
+    }
+    std::string Board::ToFen(const unsigned int &halfmove_clock, const unsigned int &fullmove_number) const
+    {
+        static const std::array<const char *, 2> cFenPieceChars = {" KQBNRP", " kqbnrp"};
+
+        std::string fen;
+        fen.reserve(96);
+
+        for (int y = 7; y >= 0; y--)
         {
-            int rook_position = m.m_from + 3;
-            int rook_target_position = m.m_from + 1;
-            Piece &rook = next_state_board_pieces[rook_position];
+            int num_empty_fields = 0;
+            for (int x = 0; x < 8; x++)
+            {
+                Piece piece = get_piece_at(x + y * 8);
+                if (piece.get_type() == Piece::Type::Empty)
+                {
+                    num_empty_fields++;
+                    continue;
+                }
 
-            next_state_board_pieces[rook_target_position] = rook;
-            next_state_board_pieces[rook_position] = Piece::Empty();
+                if (num_empty_fields > 0)
+                    fen += (char)('0' + num_empty_fields);
+                num_empty_fields = 0;
 
-            rook.IncrementStepsTaken();
+                fen += cFenPieceChars[(int)piece.get_colour()][(int)piece.get_type()];
+            }
+
+            if (num_empty_fields > 0)
+                fen += (char)('0' + num_empty_fields);
+            if (y > 0)
+                fen += '/';
         }
-        else if (m.isEnpassant(moving_piece, *this))
+
+        fen += m_active_player == Piece::Colour::White ? " w " : " b ";
+
+        if (m_castling_rights == 0)
+            fen += '-';
+        if (m_castling_rights & cWhiteKingsideCastling)
+            fen += 'K';
+        if (m_castling_rights & cWhiteQueensideCastling)
+            fen += 'Q';
+        if (m_castling_rights & cBlackKingsideCastling)
+            fen += 'k';
+        if (m_castling_rights & cBlackQueensideCastling)
+            fen += 'q';
+
+        fen += ' ';
+        if (m_en_passant_field >= 0)
         {
-            int captured_pawn_position = m.m_from + (m.m_to % 8) - (m.m_from % 8);
-            Piece captured_pawn = next_state_board_pieces[captured_pawn_position];
+            fen += (char)('a' + m_en_passant_field % 8);
+            fen += (char)('1' + m_en_passant_field / 8);
+        }
+        else
+            fen += '-';
+
+        fen += ' ';
+        fen += std::to_string(halfmove_clock);
+        fen += ' ';
+        fen += std::to_string(fullmove_number);
+
+        return fen;
+    }
+
+    Board::UndoInfo Board::MakeMove(const Move &m)
+    {
+        int from = m.get_from();
+        int to = m.get_to();
+
+        Piece::Colour player = get_piece_at(from).get_colour();
+        if (player == Piece::Colour::None)
+            throw std::invalid_argument("there is no piece to move!");
 
-            next_state_board_pieces[captured_pawn_position] = Piece::Empty();
+        // the flags tell what kind of move m is, only generated moves carry them
+        Piece::Colour opponent = Game::Opponent(player);
+        Piece::Type captured_type = m.isCapture() && !m.isEnpassant() ? get_type_at(to, opponent) : Piece::Type::Empty;
+        UndoInfo undo_info = {m, get_type_at(from, player), captured_type, m_castling_rights, m_en_passant_field, m_key};
+        Piece::Type placed_type = m.isPawnPromotion() ? m.get_promotion_type() : undo_info.moved_type;
 
-            captured_points += captured_pawn.get_worth();
+        if (captured_type != Piece::Type::Empty)
+            RemovePiece(to, opponent, captured_type);
+
+        RemovePiece(from, player, undo_info.moved_type);
+
+        if (m.isQueensideCastling())
+        {
+            RemovePiece(from - 4, player, Piece::Type::Rook);
+            PutPiece(from - 1, player, Piece::Type::Rook);
         }
-        else if (m.isPawnPromotion(moving_piece))
+        else if (m.isKingsideCastling())
         {
-            moving_piece = Piece::Queen(moving_piece.get_colour());
+            RemovePiece(from + 3, player, Piece::Type::Rook);
+            PutPiece(from + 1, player, Piece::Type::Rook);
         }
+        else if (m.isEnpassant())
+        {
+            // the captured pawn stands behind the en passant field
+            int captured_pawn_position = to + (player == Board::cPlayerAtTop ? -8 : 8);
+            RemovePiece(captured_pawn_position, opponent, Piece::Type::Pawn);
+            undo_info.captured_type = Piece::Type::Pawn;
+        }
+
+        PutPiece(to, player, placed_type);
+
+        // PutPiece and RemovePiece already updated the key for the pieces
+        if (m_en_passant_field >= 0)
+            m_key ^= zobrist::cKeys.en_passant_file[m_en_passant_field % 8];
+        m_key ^= zobrist::cKeys.castling_rights[m_castling_rights];
 
-        // count captured_points
-        captured_points += captured_piece.get_worth();
+        m_castling_rights &= cCastlingRightsMasks[from] & cCastlingRightsMasks[to];
+        m_en_passant_field = m.get_flags() == Move::cDoublePawnPush ? (from + to) / 2 : -1;
+        m_active_player = opponent;
 
-        // move piece
-        moving_piece.IncrementStepsTaken();
-        next_state_board_pieces[m.m_to] = moving_piece;
-        next_state_board_pieces[m.m_from] = Piece::Empty();
+        if (m_en_passant_field >= 0)
+            m_key ^= zobrist::cKeys.en_passant_file[m_en_passant_field % 8];
+        m_key ^= zobrist::cKeys.castling_rights[m_castling_rights] ^ zobrist::cKeys.black_to_move;
 
-        return Board(next_state_board_pieces);
+#if defined(CHESS_LIB_CHECK_KEYS)
+        // not an assert, the check has to run in release builds too
+        if (m_key != ComputeKey())
+            throw std::logic_error("incremental zobrist key differs from the computed one!");
+#endif
+
+        return undo_info;
     }
-    std::vector<Move> Board::GeneratePseudoLegalMoves(const Piece::Colour &player) const
+    void Board::UnmakeMove(const UndoInfo &undo_info)
     {
-        std::vector<Move> pseudo_legal_moves;
+        const Move &m = undo_info.move;
+        int from = m.get_from();
+        int to = m.get_to();
 
-        unsigned int num_pieces = m_pieces.size();
-        for (unsigned int piece_position = 0; piece_position < num_pieces; piece_position++)
-        {
-            const Piece &ith_piece = m_pieces[piece_position];
+        Piece::Colour opponent = m_active_player;
+        Piece::Colour player = Game::Opponent(opponent);
+
+        RemovePiece(to, player, m.isPawnPromotion() ? m.get_promotion_type() : undo_info.moved_type);
+        PutPiece(from, player, undo_info.moved_type);
 
-            if (ith_piece.get_colour() == player)
-                ith_piece.GeneratePseudoLegalMoves(piece_position, pseudo_legal_moves, *this);
+        if (m.isQueensideCastling())
+        {
+            RemovePiece(from - 1, player, Piece::Type::Rook);
+            PutPiece(from - 4, player, Piece::Type::Rook);
+        }
+        else if (m.isKingsideCastling())
+        {
+            RemovePiece(from + 1, player, Piece::Type::Rook);
+            PutPiece(from + 3, player, Piece::Type::Rook);
+        }
+        else if (m.isEnpassant())
+        {
+            PutPiece(to + (player == Board::cPlayerAtTop ? -8 : 8), opponent, Piece::Type::Pawn);
+        }
+        else if (undo_info.captured_type != Piece::Type::Empty)
+        {
+            PutPiece(to, opponent, undo_info.captured_type);
         }
 
+        m_castling_rights = undo_info.castling_rights;
+        m_en_passant_field = undo_info.en_passant_field;
+        m_active_player = player;
+        m_key = undo_info.key;
+    }
+    Board::UndoInfo Board::MakeNullMove()
+    {
+        UndoInfo undo_info = {Move(), Piece::Type::Empty, Piece::Type::Empty, m_castling_rights, m_en_passant_field, m_key};
+
+        if (m_en_passant_field >= 0)
+            m_key ^= zobrist::cKeys.en_passant_file[m_en_passant_field % 8];
+        m_key ^= zobrist::cKeys.black_to_move;
+
+        m_en_passant_field = -1;
+        m_active_player = Game::Opponent(m_active_player);
+
+#if defined(CHESS_LIB_CHECK_KEYS)
+        // not an assert, the check has to run in release builds too
+        if (m_key != ComputeKey())
+            throw std::logic_error("incremental zobrist key differs from the computed one!");
+#endif
+
+        return undo_info;
+    }
+    void Board::UnmakeNullMove(const UndoInfo &undo_info)
+    {
+        m_en_passant_field = undo_info.en_passant_field;
+        m_active_player = Game::Opponent(m_active_player);
+        m_key = undo_info.key;
+    }
+
+    Board Board::MovePiece(const Move &m) const
+    {
+        Board next_state = *this;
+        next_state.MakeMove(m);
+
+        return next_state;
+    }
+    MoveList Board::GeneratePseudoLegalMoves(const Piece::Colour &player) const
+    {
+        MoveList pseudo_legal_moves;
+
+        bitboard::Bitboard player_pieces = get_occupancy(player);
+        while (player_pieces)
+            GeneratePseudoLegalMoves(bitboard::PopLowestField(player_pieces), pseudo_legal_moves);
+
         return pseudo_legal_moves;
     }
+    void Board::GeneratePseudoLegalMoves(const unsigned int &field, MoveList &pseudo_legal_moves) const
+    {
+        Piece::Colour player = get_piece_at(field).get_colour();
+        if (player == Piece::Colour::None)
+            return;
 
-    bool Board::isKingUnderAttack(const Piece::Colour &king_owner, const std::vector<Move> &pseudo_legal_moves) const
+        Piece::Type type = get_type_at(field, player);
+        bitboard::Bitboard targets = get_move_targets(field, player, type);
+
+        if (type == Piece::Type::King)
+            GenerateCastlingMoves(field, player, pseudo_legal_moves);
+
+        PushMoves(field, player, type, targets, pseudo_legal_moves);
+    }
+    void Board::PushMoves(const int &field, const Piece::Colour &player, const Piece::Type &type, bitboard::Bitboard targets, MoveList &moves) const
     {
-        const unsigned int num_pseudo_legal_moves = pseudo_legal_moves.size();
-        for (unsigned int i = 0; i < num_pseudo_legal_moves; i++)
+        bitboard::Bitboard opponent_pieces = get_occupancy(Game::Opponent(player));
+
+        while (targets)
         {
-            Move ith_pseudo_legal_move = pseudo_legal_moves[i];
-            const Piece &piece_under_attack = m_pieces[ith_pseudo_legal_move.m_to];
+            int target = bitboard::PopLowestField(targets);
+            unsigned int flags = (opponent_pieces & bitboard::FieldBitboard(target)) ? Move::cCapture : Move::cQuiet;
 
-            if (piece_under_attack.get_type() == Piece::Type::King && piece_under_attack.get_colour() == king_owner)
-                return true;
-        }
+            if (type == Piece::Type::Pawn)
+            {
+                if (target == m_en_passant_field && player == m_active_player)
+                    flags = Move::cEnPassant;
+                else if (abs(target - field) == 16)
+                    flags = Move::cDoublePawnPush;
+                else if (target / 8 == 0 || target / 8 == 7)
+                {
+                    // queen first
+                    for (int promotion = 3; promotion >= 0; promotion--)
+                        moves.push_back(Move(field, target, flags | Move::cPromotion | promotion));
+                    continue;
+                }
+            }
 
-        return false;
+            moves.push_back(Move(field, target, flags));
+        }
     }
-
-    std::string EncodePiece(const Piece &piece)
+    bitboard::Bitboard Board::get_move_targets(const int &field, const Piece::Colour &player, const Piece::Type &type) const
     {
-        Piece::Colour piece_colour = piece.get_colour();
+        bitboard::Bitboard own_pieces = get_occupancy(player);
+        bitboard::Bitboard opponent_pieces = get_occupancy(Game::Opponent(player));
+        bitboard::Bitboard occupancy = own_pieces | opponent_pieces;
 
-        switch (piece.get_type())
+        switch (type)
         {
         case Piece::Type::King:
-            if (piece_colour == Piece::Colour::White)
-                return "♚";
-            else
-                return "♔";
-            break;
+            return bitboard::cKingAttacks[field] & ~own_pieces;
 
         case Piece::Type::Queen:
-            if (piece_colour == Piece::Colour::White)
-                return "♛";
-            else
-                return "♕";
-            break;
-        case Piece::Type::Rook:
-            if (piece_colour == Piece::Colour::White)
-                return "♜";
-            else
-                return "♖";
-            break;
+            return bitboard::QueenAttacks(field, occupancy) & ~own_pieces;
+
         case Piece::Type::Bishop:
-            if (piece_colour == Piece::Colour::White)
-                return "♝";
-            else
-                return "♗";
-            break;
+            return bitboard::BishopAttacks(field, occupancy) & ~own_pieces;
+
         case Piece::Type::Knight:
-            if (piece_colour == Piece::Colour::White)
-                return "♞";
-            else
-                return "♘";
-            break;
+            return bitboard::cKnightAttacks[field] & ~own_pieces;
+
+        case Piece::Type::Rook:
+            return bitboard::RookAttacks(field, occupancy) & ~own_pieces;
+
         case Piece::Type::Pawn:
-            if (piece_colour == Piece::Colour::White)
-                return "♟︎";
-            else
-                return "♙";
-            break;
+        {
+            // pawns never stand on the last rank, thus one field ahead is always on the board
+            int advancing_direction = player == Board::cPlayerAtTop ? 8 : -8;
+            bitboard::Bitboard starting_rank = player == Board::cPlayerAtTop ? bitboard::cRank2 : bitboard::cRank7;
+            bitboard::Bitboard targets = bitboard::cEmpty;
+
+            int one_ahead = field + advancing_direction;
+            if (!(occupancy & bitboard::FieldBitboard(one_ahead)))
+            {
+                targets |= bitboard::FieldBitboard(one_ahead);
+
+                // double opening
+                if ((starting_rank & bitboard::FieldBitboard(field)) && !(occupancy & bitboard::FieldBitboard(one_ahead + advancing_direction)))
+                    targets |= bitboard::FieldBitboard(one_ahead + advancing_direction);
+            }
+
+            bitboard::Bitboard capturable = opponent_pieces;
+            if (m_en_passant_field >= 0 && player == m_active_player)
+                capturable |= bitboard::FieldBitboard(m_en_passant_field);
+
+            return targets | (bitboard::cPawnAttacks[(int)player][field] & capturable);
+        }
         default:
-            return " ";
-            break;
+            return bitboard::cEmpty;
+        }
+    }
+    void Board::GenerateCastlingMoves(const int &field, const Piece::Colour &player, MoveList &moves) const
+    {
+        // the king may neither stand on nor pass an attacked field
+        Piece::Colour opponent = Game::Opponent(player);
+        bitboard::Bitboard occupancy = get_occupancy();
+
+        bool is_white = player == Piece::Colour::White;
+        int king_field = is_white ? 4 : 60;
+        unsigned char kingside_castling = is_white ? cWhiteKingsideCastling : cBlackKingsideCastling;
+        unsigned char queenside_castling = is_white ? cWhiteQueensideCastling : cBlackQueensideCastling;
+
+        if (field != king_field || !(m_castling_rights & (kingside_castling | queenside_castling)) ||
+            isFieldAttacked(king_field, opponent))
+            return;
+
+        if ((m_castling_rights & kingside_castling) &&
+            !(occupancy & (bitboard::FieldBitboard(king_field + 1) | bitboard::FieldBitboard(king_field + 2))) &&
+            !isFieldAttacked(king_field + 1, opponent) && !isFieldAttacked(king_field + 2, opponent))
+            moves.push_back(Move(king_field, king_field + 2, Move::cKingsideCastling));
+
+        if ((m_castling_rights & queenside_castling) &&
+            !(occupancy & (bitboard::FieldBitboard(king_field - 1) | bitboard::FieldBitboard(king_field - 2) | bitboard::FieldBitboard(king_field - 3))) &&
+            !isFieldAttacked(king_field - 1, opponent) && !isFieldAttacked(king_field - 2, opponent))
+            moves.push_back(Move(king_field, king_field - 2, Move::cQueensideCastling));
+    }
+
+    MoveList Board::GenerateLegalMoves() const
+    {
+        MoveList legal_moves;
+        GenerateLegalMoves(legal_moves, cAllMoves);
+
+        return legal_moves;
+    }
+    void Board::GenerateLegalMoves(MoveList &legal_moves, const unsigned int &kinds, const bitboard::Bitboard &from_fields) const
+    {
+        Piece::Colour player = m_active_player;
+        Piece::Colour opponent = Game::Opponent(player);
+
+        bitboard::Bitboard king = get_pieces(player, Piece::Type::King);
+        if (!king)
+        {
+            // nothing to protect, every pseudo legal move is legal
+            MoveList pseudo_legal_moves = GeneratePseudoLegalMoves(player);
+            for (const Move &m : pseudo_legal_moves)
+            {
+                bool is_capture_move = m.isCapture() || m.isPawnPromotion();
+                if ((from_fields & bitboard::FieldBitboard(m.get_from())) && (kinds & (is_capture_move ? cCaptureMoves : cQuietMoves)))
+                    legal_moves.push_back(m);
+            }
+            return;
+        }
+
+        int king_field = bitboard::LowestField(king);
+        bitboard::Bitboard own_pieces = get_occupancy(player);
+        bitboard::Bitboard opponent_pieces = get_occupancy(opponent);
+        bitboard::Bitboard occupancy = get_occupancy();
+        bitboard::Bitboard opponent_queens = get_pieces(opponent, Piece::Type::Queen);
+        bitboard::Bitboard opponent_straight_sliders = get_pieces(opponent, Piece::Type::Rook) | opponent_queens;
+        bitboard::Bitboard opponent_diagonal_sliders = get_pieces(opponent, Piece::Type::Bishop) | opponent_queens;
+
+        bitboard::Bitboard checkers = get_attackers(king_field, opponent, occupancy);
+
+        // a piece is pinned if it is the only one between its king and an opponent slider aiming at the king
+        // it may only move along the line through both
+        bitboard::Bitboard pinned = bitboard::cEmpty;
+        bitboard::Bitboard snipers = (bitboard::RookAttacks(king_field, get_occupancy(opponent)) & opponent_straight_sliders) |
+                                     (bitboard::BishopAttacks(king_field, get_occupancy(opponent)) & opponent_diagonal_sliders);
+        while (snipers)
+        {
+            bitboard::Bitboard blockers = bitboard::Between(king_field, bitboard::PopLowestField(snipers)) & occupancy;
+            if (bitboard::Count(blockers) == 1)
+                pinned |= blockers & own_pieces;
+        }
+
+        // in check every other piece has to capture the checker or block its ray, in double check only the king may move
+        bitboard::Bitboard evasion_targets = ~bitboard::cEmpty;
+        if (bitboard::Count(checkers) > 1)
+            evasion_targets = bitboard::cEmpty;
+        else if (checkers)
+            evasion_targets = checkers | bitboard::Between(king_field, bitboard::LowestField(checkers));
+
+        // promotions count as captures, they change the material as well
+        bitboard::Bitboard capture_targets = opponent_pieces;
+        bitboard::Bitboard pawn_capture_targets = opponent_pieces | bitboard::cRank1 | bitboard::cRank8;
+        if (m_en_passant_field >= 0)
+            pawn_capture_targets |= bitboard::FieldBitboard(m_en_passant_field);
+
+        bitboard::Bitboard player_pieces = own_pieces & from_fields;
+        while (player_pieces)
+        {
+            int field = bitboard::PopLowestField(player_pieces);
+            Piece::Type type = get_type_at(field, player);
+            bitboard::Bitboard targets = get_move_targets(field, player, type);
+
+            bitboard::Bitboard kind_targets = bitboard::cEmpty;
+            bitboard::Bitboard piece_capture_targets = type == Piece::Type::Pawn ? pawn_capture_targets : capture_targets;
+            if (kinds & cCaptureMoves)
+                kind_targets |= piece_capture_targets;
+            if (kinds & cQuietMoves)
+                kind_targets |= ~piece_capture_targets;
+            targets &= kind_targets;
+
+            if (type == Piece::Type::King)
+            {
+                // without the king on the board sliders also attack the fields behind it
+                bitboard::Bitboard occupancy_without_king = occupancy ^ king;
+                bitboard::Bitboard safe_targets = bitboard::cEmpty;
+                while (targets)
+                {
+                    int target = bitboard::PopLowestField(targets);
+                    if (!get_attackers(target, opponent, occupancy_without_king))
+                        safe_targets |= bitboard::FieldBitboard(target);
+                }
+                targets = safe_targets;
+
+                if (!checkers && (kinds & cQuietMoves))
+                    GenerateCastlingMoves(field, player, legal_moves);
+            }
+            else
+            {
+                bitboard::Bitboard en_passant = bitboard::cEmpty;
+                if (type == Piece::Type::Pawn && m_en_passant_field >= 0)
+                    en_passant = targets & bitboard::FieldBitboard(m_en_passant_field);
+
+                targets &= evasion_targets;
+                if (pinned & bitboard::FieldBitboard(field))
+                    targets &= bitboard::Line(king_field, field);
+
+                // en passant removes two pieces of one rank, thus it is checked on the board after the move
+                if (en_passant)
+                {
+                    int captured_field = m_en_passant_field + (player == Board::cPlayerAtTop ? -8 : 8);
+                    bitboard::Bitboard occupancy_after = (occupancy ^ bitboard::FieldBitboard(field) ^ bitboard::FieldBitboard(captured_field)) | en_passant;
+
+                    if (get_attackers(king_field, opponent, occupancy_after) & ~bitboard::FieldBitboard(captured_field))
+                        targets &= ~en_passant;
+                    else
+                        targets |= en_passant;
+                }
+            }
+
+            PushMoves(field, player, type, targets, legal_moves);
+        }
+    }
+    bool Board::isLegal(const Move &m) const
+    {
+        MoveList legal_moves;
+        GenerateLegalMoves(legal_moves, cAllMoves, bitboard::FieldBitboard(m.get_from()));
+
+        for (const Move &legal_move : legal_moves)
+        {
+            if (legal_move == m)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool Board::isKingUnderAttack(const Piece::Colour &king_owner, const MoveList &pseudo_legal_moves) const
+    {
+        bitboard::Bitboard king = get_pieces(king_owner, Piece::Type::King);
+
+        for (const Move &pseudo_legal_move : pseudo_legal_moves)
+        {
+            if (king & bitboard::FieldBitboard(pseudo_legal_move.get_to()))
+                return true;
         }
+
+        return false;
+    }
+    bool Board::isFieldAttacked(const int &field, const Piece::Colour &attacker) const
+    {
+        return get_attackers(field, attacker, get_occupancy());
+    }
+    bitboard::Bitboard Board::get_attackers(const int &field, const Piece::Colour &attacker, const bitboard::Bitboard &occupancy) const
+    {
+        bitboard::Bitboard queens = get_pieces(attacker, Piece::Type::Queen);
+
+        // a piece on field attacks the attackers pieces exactly if they attack field
+        return (bitboard::cPawnAttacks[(int)Game::Opponent(attacker)][field] & get_pieces(attacker, Piece::Type::Pawn)) |
+               (bitboard::cKnightAttacks[field] & get_pieces(attacker, Piece::Type::Knight)) |
+               (bitboard::cKingAttacks[field] & get_pieces(attacker, Piece::Type::King)) |
+               (bitboard::BishopAttacks(field, occupancy) & (get_pieces(attacker, Piece::Type::Bishop) | queens)) |
+               (bitboard::RookAttacks(field, occupancy) & (get_pieces(attacker, Piece::Type::Rook) | queens));
+    }
+    bool Board::isInCheck(const Piece::Colour &king_owner) const
+    {
+        bitboard::Bitboard king = get_pieces(king_owner, Piece::Type::King);
+
+        return king && isFieldAttacked(bitboard::LowestField(king), Game::Opponent(king_owner));
     }
 
     std::string Board::ToString() const
@@ -199,16 +717,16 @@ namespace chess
             for (unsigned int x = 0; x < 8; x++)
             {
                 int field_index = x + y * 8;
-                Piece piece_on_field = m_pieces[field_index];
+                Piece piece_on_field = get_piece_at(field_index);
 
                 if(piece_on_field.get_type() == Piece::Type::Empty){
                 // create checkered pattern
-                    if (abs(field_index % 2 - y % 2))
+                    if ((field_index + (int)y) % 2)
                         row_string.append("." + piece_buffer);
                     else
                         row_string.append("_" + piece_buffer);
                 } else {
-                    row_string.append(EncodePiece(piece_on_field) + piece_buffer);
+                    row_string.append(piece_on_field.get_glyph() + piece_buffer);
                 }
             }
 
@@ -220,15 +738,110 @@ namespace chess
 
         return board_string;
     }
+
     Piece Board::get_piece_at(const int &field_index) const
     {
-        if (field_index < 0 || field_index >= 64)
-            throw std::invalid_argument("field_index out of bounds");
+        assert(field_index >= 0 && field_index < 64);
+
+        bitboard::Bitboard field = bitboard::FieldBitboard(field_index);
+        Piece::Colour colour = (m_occupancy[0] & field) ? Piece::Colour::White : Piece::Colour::Black;
+        Piece::Type type = get_type_at(field_index, colour);
+
+        return Piece(type, type == Piece::Type::Empty ? Piece::Colour::None : colour);
+    }
+
+    bitboard::Bitboard Board::get_pieces(const Piece::Colour &colour, const Piece::Type &type) const
+    {
+        return m_pieces[BitboardIndex(colour, type)];
+    }
+    bitboard::Bitboard Board::get_occupancy(const Piece::Colour &colour) const
+    {
+        return m_occupancy[(int)colour];
+    }
+    bitboard::Bitboard Board::get_occupancy() const
+    {
+        return m_occupancy[0] | m_occupancy[1];
+    }
+
+    unsigned char Board::get_castling_rights() const
+    {
+        return m_castling_rights;
+    }
+    int Board::get_en_passant_field() const
+    {
+        return m_en_passant_field;
+    }
+    Piece::Colour Board::get_active_player() const
+    {
+        return m_active_player;
+    }
+    int Board::get_material(const Piece::Colour &colour) const
+    {
+        return m_material[(int)colour];
+    }
+    zobrist::Key Board::get_key() const
+    {
+        return m_key;
+    }
+    zobrist::Key Board::ComputeKey() const
+    {
+        zobrist::Key key = zobrist::cKeys.castling_rights[m_castling_rights];
+
+        for (int index = 0; index < 12; index++)
+        {
+            bitboard::Bitboard pieces = m_pieces[index];
+            while (pieces)
+                key ^= zobrist::cKeys.pieces[index][bitboard::PopLowestField(pieces)];
+        }
+
+        if (m_en_passant_field >= 0)
+            key ^= zobrist::cKeys.en_passant_file[m_en_passant_field % 8];
+        if (m_active_player == Piece::Colour::Black)
+            key ^= zobrist::cKeys.black_to_move;
+
+        return key;
+    }
+
+    Board::Board() : m_pieces(),
+                     m_occupancy(),
+                     m_key(0),
+                     m_material(),
+                     m_castling_rights(0),
+                     m_en_passant_field(-1),
+                     m_active_player(Piece::Colour::White)
+    {
+    }
+
+    void Board::PutPiece(const int &field, const Piece::Colour &colour, const Piece::Type &type)
+    {
+        m_pieces[BitboardIndex(colour, type)] |= bitboard::FieldBitboard(field);
+        m_occupancy[(int)colour] |= bitboard::FieldBitboard(field);
+        m_material[(int)colour] += Piece::cWorth[(int)type];
+        m_key ^= zobrist::cKeys.pieces[BitboardIndex(colour, type)][field];
+    }
+    void Board::RemovePiece(const int &field, const Piece::Colour &colour, const Piece::Type &type)
+    {
+        m_pieces[BitboardIndex(colour, type)] &= ~bitboard::FieldBitboard(field);
+        m_occupancy[(int)colour] &= ~bitboard::FieldBitboard(field);
+        m_material[(int)colour] -= Piece::cWorth[(int)type];
+        m_key ^= zobrist::cKeys.pieces[BitboardIndex(colour, type)][field];
+    }
+    Piece::Type Board::get_type_at(const int &field, const Piece::Colour &colour) const
+    {
+        if (colour == Piece::Colour::None || !(m_occupancy[(int)colour] & bitboard::FieldBitboard(field)))
+            return Piece::Type::Empty;
+
+        for (const Piece::Type &type : cPieceTypes)
+        {
+            if (get_pieces(colour, type) & bitboard::FieldBitboard(field))
+                return type;
+        }
 
-        return m_pieces[field_index];
+        return Piece::Type::Empty;
     }
 
-    Board::Board(const std::array<Piece, 64> &pieces) : m_pieces(pieces)
+    int Board::BitboardIndex(const Piece::Colour &colour, const Piece::Type &type)
     {
+        return (int)colour * 6 + (int)type - 1;
     }
 } // namespace chess
\ No newline at end of file
@@ -4,29 +4,56 @@ namespace chess
 {
     Game::Game() : m_active_player(Piece::Colour::White),
                    m_board(Board::BasicSetup()),
+                   m_halfmove_clock(0),
+                   m_fullmove_number(1),
+                   m_undo_infos(),
                    m_current_state_legal_moves()
     {
         m_current_state_legal_moves = GenerateLegalMoves();
     }
+    Game Game::FromFen(std::string_view fen)
+    {
+        unsigned int halfmove_clock, fullmove_number;
+        Board board = Board::FromFen(fen, halfmove_clock, fullmove_number);
+
+        return Game(board, board.get_active_player(), halfmove_clock, fullmove_number);
+    }
+    std::string Game::ToFen() const
+    {
+        return m_board.ToFen(m_halfmove_clock, m_fullmove_number);
+    }
 
     bool Game::MovePiece(const Move &m)
     {
         // check if move is legal
-        bool move_is_legal;
-        unsigned int num_legal_moves = m_current_state_legal_moves.size();
-        for (unsigned int i = 0; i < num_legal_moves; i++)
+        // m may come without flags (user input, agent actions), thus it is matched by its fields
+        // and promotes to a queen unless it asks for another piece
+        Piece::Type promotion_type = m.isPawnPromotion() ? m.get_promotion_type() : Piece::Type::Queen;
+        const Move *legal_move = nullptr;
+        for (const Move &cur_legal_move : m_current_state_legal_moves)
         {
-            if (m_current_state_legal_moves[i] == m)
-                move_is_legal = true;
+            if (cur_legal_move.get_from() == m.get_from() && cur_legal_move.get_to() == m.get_to() &&
+                (!cur_legal_move.isPawnPromotion() || cur_legal_move.get_promotion_type() == promotion_type))
+            {
+                legal_move = &cur_legal_move;
+                break;
+            }
         }
 
-        if (!move_is_legal)
+        if (legal_move == nullptr)
         {
             throw std::invalid_argument("Parameter needs to be a legal move!");
         }
 
+        // captures and pawn moves can not be undone, thus they reset the clock
+        unsigned int halfmove_clock = m_halfmove_clock;
+        bool is_irreversible = legal_move->isCapture() || m_board.get_piece_at(legal_move->get_from()).get_type() == Piece::Type::Pawn;
+        m_halfmove_clock = is_irreversible ? 0 : m_halfmove_clock + 1;
+        if (m_active_player == Piece::Colour::Black)
+            m_fullmove_number++;
+
         // move pieces
-        m_board = m_board.MovePiece(m);
+        m_undo_infos.push_back({m_board.MakeMove(*legal_move), halfmove_clock});
 
         // opponent becomes active player
         m_active_player = Opponent(m_active_player);
@@ -40,10 +67,28 @@ namespace chess
 
         return false;
     }
+    void Game::UnmakeMove()
+    {
+        if (m_undo_infos.empty())
+            throw std::logic_error("there is no move to undo!");
+
+        m_board.UnmakeMove(m_undo_infos.back().board_undo_info);
+        m_halfmove_clock = m_undo_infos.back().halfmove_clock;
+        m_undo_infos.pop_back();
+
+        m_active_player = Opponent(m_active_player);
+        if (m_active_player == Piece::Colour::Black)
+            m_fullmove_number--;
+
+        m_current_state_legal_moves = GenerateLegalMoves();
+    }
     void Game::Reset()
     {
         m_board = Board::BasicSetup();
         m_active_player = Piece::Colour::White;
+        m_halfmove_clock = 0;
+        m_fullmove_number = 1;
+        m_undo_infos.clear();
 
         m_current_state_legal_moves = GenerateLegalMoves();
     }
@@ -56,9 +101,21 @@ namespace chess
     {
         return m_active_player;
     }
-    std::vector<Move> Game::get_legal_moves() const
+    std::span<const Move> Game::get_legal_moves() const
     {
-        return m_current_state_legal_moves;
+        return {m_current_state_legal_moves.begin(), m_current_state_legal_moves.end()};
+    }
+    zobrist::Key Game::get_key() const
+    {
+        return m_board.get_key();
+    }
+    unsigned int Game::get_halfmove_clock() const
+    {
+        return m_halfmove_clock;
+    }
+    unsigned int Game::get_fullmove_number() const
+    {
+        return m_fullmove_number;
     }
 
     Piece::Colour Game::Opponent(const Piece::Colour &active_player)
@@ -70,24 +127,18 @@ namespace chess
     }
 
 
-    std::vector<Move> Game::GenerateLegalMoves() const
+    Game::Game(const Board &board, const Piece::Colour &active_player, const unsigned int &halfmove_clock, const unsigned int &fullmove_number) : m_active_player(active_player),
+                                                                                                                                                 m_board(board),
+                                                                                                                                                 m_halfmove_clock(halfmove_clock),
+                                                                                                                                                 m_fullmove_number(fullmove_number),
+                                                                                                                                                 m_undo_infos(),
+                                                                                                                                                 m_current_state_legal_moves()
     {
-        std::vector<Move> pseudo_legal_moves = m_board.GeneratePseudoLegalMoves(m_active_player);
-        std::vector<Move> legal_moves;
-
-        unsigned int num_pseudo_legal_moves = pseudo_legal_moves.size();
-        for (unsigned int i = 0; i < num_pseudo_legal_moves; i++)
-        {
-            Move ith_move = pseudo_legal_moves[i];
-            Board ith_move_next_state = m_board.MovePiece(ith_move);
-
-            Piece::Colour active_player_opponent = Game::Opponent(m_active_player);
-            std::vector<Move> next_state_opponent_pseudo_legal_moves = ith_move_next_state.GeneratePseudoLegalMoves(active_player_opponent);
-
-            if (!ith_move_next_state.isKingUnderAttack(m_active_player, next_state_opponent_pseudo_legal_moves))
-                legal_moves.push_back(ith_move);
-        }
+        m_current_state_legal_moves = GenerateLegalMoves();
+    }
 
-        return legal_moves;
+    MoveList Game::GenerateLegalMoves() const
+    {
+        return m_board.GenerateLegalMoves();
     }
 } // namespace chess
\ No newline at end of file
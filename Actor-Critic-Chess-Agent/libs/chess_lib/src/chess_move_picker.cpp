@@ -0,0 +1,153 @@
+#include "chess_lib/move_picker.h"
+
+namespace chess
+{
+    MovePicker::MovePicker(const Board &board, const Move &hash_move, const std::array<Move, cNumKillers> &killers) : m_board(board),
+                                                                                                                       m_hash_move(hash_move),
+                                                                                                                       m_killers(killers),
+                                                                                                                       m_captures_only(false),
+                                                                                                                       m_stage(Stage::HashMove),
+                                                                                                                       m_index(0)
+    {
+    }
+    MovePicker::MovePicker(const Board &board, const Move &hash_move) : m_board(board),
+                                                                        m_hash_move(hash_move),
+                                                                        m_killers(),
+                                                                        m_captures_only(true),
+                                                                        m_stage(Stage::HashMove),
+                                                                        m_index(0)
+    {
+    }
+
+    bool MovePicker::Next(Move &move)
+    {
+        switch (m_stage)
+        {
+        case Stage::HashMove:
+        {
+            m_stage = Stage::GenerateCaptures;
+
+            // the hash move may stem from another position with the same key
+            bool is_capture_move = m_hash_move.isCapture() || m_hash_move.isPawnPromotion();
+            if (!(m_hash_move == Move()) && (is_capture_move || !m_captures_only) && m_board.isLegal(m_hash_move))
+            {
+                move = m_hash_move;
+                return true;
+            }
+
+            m_hash_move = Move();
+            [[fallthrough]];
+        }
+        case Stage::GenerateCaptures:
+        {
+            m_moves.clear();
+            m_board.GenerateLegalMoves(m_moves, Board::cCaptureMoves);
+
+            // most valuable victim first, the least valuable attacker breaks ties
+            for (unsigned int i = 0; i < m_moves.size(); i++)
+            {
+                const Move &capture = m_moves[i];
+                Piece::Type victim = capture.isEnpassant() ? Piece::Type::Pawn : m_board.get_piece_at(capture.get_to()).get_type();
+                Piece::Type attacker = m_board.get_piece_at(capture.get_from()).get_type();
+
+                m_scores[i] = 8 * Piece::cWorth[(int)victim] - Piece::cWorth[(int)attacker];
+                if (capture.isPawnPromotion())
+                    m_scores[i] += 8 * Piece::cWorth[(int)capture.get_promotion_type()];
+            }
+
+            m_index = 0;
+            m_stage = Stage::Captures;
+            [[fallthrough]];
+        }
+        case Stage::Captures:
+            while (m_index < m_moves.size())
+            {
+                move = m_moves[SelectBest()];
+                m_index++;
+
+                if (!isReturnedEarlier(move))
+                    return true;
+            }
+
+            m_index = 0;
+            m_stage = m_captures_only ? Stage::Done : Stage::Killers;
+            if (m_captures_only)
+                return false;
+            [[fallthrough]];
+
+        case Stage::Killers:
+            while (m_index < cNumKillers)
+            {
+                const Move &killer = m_killers[m_index++];
+
+                // killers are quiet moves of sibling positions, they may be captures or illegal here
+                if (killer == Move() || killer == m_hash_move || killer.isCapture() || killer.isPawnPromotion() ||
+                    (&killer != &m_killers[0] && killer == m_killers[0]) || !m_board.isLegal(killer))
+                    continue;
+
+                move = killer;
+                return true;
+            }
+
+            m_stage = Stage::GenerateQuiets;
+            [[fallthrough]];
+
+        case Stage::GenerateQuiets:
+            m_moves.clear();
+            m_board.GenerateLegalMoves(m_moves, Board::cQuietMoves);
+
+            m_index = 0;
+            m_stage = Stage::Quiets;
+            [[fallthrough]];
+
+        case Stage::Quiets:
+            while (m_index < m_moves.size())
+            {
+                move = m_moves[m_index++];
+
+                if (!isReturnedEarlier(move))
+                    return true;
+            }
+
+            m_stage = Stage::Done;
+            [[fallthrough]];
+
+        default:
+            return false;
+        }
+    }
+
+    bool MovePicker::isCaptureStage() const
+    {
+        return m_stage <= Stage::Captures;
+    }
+
+    unsigned int MovePicker::SelectBest()
+    {
+        unsigned int best = m_index;
+        for (unsigned int i = m_index + 1; i < m_moves.size(); i++)
+        {
+            if (m_scores[i] > m_scores[best])
+                best = i;
+        }
+
+        std::swap(m_moves[best], m_moves[m_index]);
+        std::swap(m_scores[best], m_scores[m_index]);
+
+        return m_index;
+    }
+    bool MovePicker::isReturnedEarlier(const Move &move) const
+    {
+        if (move == m_hash_move)
+            return true;
+
+        // legal quiet killers are always returned by the killer stage
+        for (const Move &killer : m_killers)
+        {
+            if (move == killer && m_stage == Stage::Quiets)
+                return true;
+        }
+
+        return false;
+    }
+} // namespace chess
\ No newline at end of file
@@ -0,0 +1,468 @@
+#include "chess_lib/search.h"
+
+#include <bit>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+namespace chess
+{
+    namespace
+    {
+        // the limits are checked every cCheckInterval nodes of a thread
+        const unsigned long long cCheckInterval = 1024;
+        const int cMaxReducedDepth = 64;
+        const int cMaxReducedMoveCount = 64;
+
+        // late move reductions grow with the remaining depth and the number of moves tried before
+        struct Reductions
+        {
+            std::array<std::array<int, cMaxReducedMoveCount>, cMaxReducedDepth> table;
+
+            Reductions()
+            {
+                for (int depth = 1; depth < cMaxReducedDepth; depth++)
+                {
+                    for (int move_count = 1; move_count < cMaxReducedMoveCount; move_count++)
+                        table[depth][move_count] = (int)(0.75 + std::log(depth) * std::log(move_count) / 2.25);
+                }
+            }
+        };
+        const Reductions cReductions;
+
+        bool hasNonPawnMaterial(const Board &board, const Piece::Colour &colour)
+        {
+            return board.get_material(colour) > std::popcount(board.get_pieces(colour, Piece::Type::Pawn));
+        }
+    } // namespace
+
+    int MaterialEvaluation(const Board &board)
+    {
+        Piece::Colour player = board.get_active_player();
+        return 100 * (board.get_material(player) - board.get_material(Game::Opponent(player)));
+    }
+
+    Search::Search(TranspositionTable &transposition_table, const unsigned int &num_threads, const Evaluation &evaluation) : m_transposition_table(transposition_table),
+                                                                                                                              m_num_threads(num_threads),
+                                                                                                                              m_evaluation(evaluation),
+                                                                                                                              m_stop(false)
+    {
+        if (num_threads == 0)
+            throw std::invalid_argument("search needs at least one thread!");
+        if (!evaluation)
+            throw std::invalid_argument("search needs an evaluation!");
+    }
+
+    SearchReport Search::Run(const Board &board, const std::vector<zobrist::Key> &position_keys, const SearchLimits &limits,
+                             const std::function<void(const SearchReport &)> &report)
+    {
+        m_limits = limits;
+        m_report = report;
+        m_start = std::chrono::steady_clock::now();
+        m_stop.store(false);
+        m_transposition_table.NewSearch();
+
+        m_workers.clear();
+        for (unsigned int id = 0; id < m_num_threads; id++)
+            m_workers.push_back(std::make_unique<Worker>(id, board, position_keys));
+
+        std::vector<std::thread> helpers;
+        for (unsigned int id = 1; id < m_num_threads; id++)
+            helpers.emplace_back(&Search::IterativeDeepening, this, std::ref(*m_workers[id]));
+
+        Worker &main_worker = *m_workers[0];
+        IterativeDeepening(main_worker);
+
+        // the helpers only stop once the main thread is done
+        m_stop.store(true);
+        for (std::thread &helper : helpers)
+            helper.join();
+
+        // a search stopped before the first depth was finished still has to name a move
+        if (main_worker.completed_depth == 0)
+        {
+            MoveList legal_moves = board.GenerateLegalMoves();
+            if (legal_moves.size() > 0)
+                main_worker.best_move = legal_moves[0];
+        }
+
+        SearchReport final_report = MakeReport(main_worker);
+        if (m_report && main_worker.completed_depth == 0 && !final_report.pv.empty())
+            m_report(final_report);
+
+        return final_report;
+    }
+    void Search::Stop()
+    {
+        m_stop.store(true);
+    }
+
+    bool Search::isMateScore(const int &score)
+    {
+        return std::abs(score) >= cMateBound;
+    }
+
+    Search::Worker::Worker(const unsigned int &id, const Board &board, const std::vector<zobrist::Key> &position_keys) : id(id),
+                                                                                                                        board(board),
+                                                                                                                        keys(position_keys),
+                                                                                                                        killers(),
+                                                                                                                        nodes(0),
+                                                                                                                        root_best_move(),
+                                                                                                                        best_move(),
+                                                                                                                        best_score(0),
+                                                                                                                        completed_depth(0)
+    {
+        keys.reserve(position_keys.size() + cMaxPly);
+    }
+
+    void Search::IterativeDeepening(Worker &worker)
+    {
+        int max_depth = m_limits.depth > 0 ? std::min(m_limits.depth, cMaxPly - 1) : cMaxPly - 1;
+        int depth_offset = worker.id % 2;
+
+        for (int depth = 1; depth + depth_offset <= max_depth; depth++)
+        {
+            int score = AlphaBeta(worker, -cInfinity, cInfinity, depth + depth_offset, 0, false);
+
+            // the moves of an interrupted depth are not all searched, its result is dropped
+            if (m_stop.load(std::memory_order_relaxed))
+                break;
+
+            worker.best_move = worker.root_best_move;
+            worker.best_score = score;
+            worker.completed_depth = depth + depth_offset;
+
+            if (worker.id != 0)
+                continue;
+
+            SearchReport report = MakeReport(worker);
+            if (m_report)
+                m_report(report);
+
+            // there is no faster mate to find
+            if (isMateScore(score) && cMateScore - std::abs(score) <= depth)
+                break;
+
+            // a new depth takes longer than all depths before, it would not finish in the remaining time
+            if (m_limits.movetime.count() > 0 && get_seconds() * 2000 >= m_limits.movetime.count())
+                break;
+        }
+
+        if (worker.id == 0)
+            m_stop.store(true);
+    }
+    int Search::AlphaBeta(Worker &worker, int alpha, int beta, int depth, const int &ply, const bool &null_move_allowed)
+    {
+        if (depth <= 0)
+            return Quiescence(worker, alpha, beta, ply);
+
+        CheckLimits(worker);
+        if (m_stop.load(std::memory_order_relaxed))
+            return 0;
+
+        Board &board = worker.board;
+        bool is_pv_node = beta - alpha > 1;
+
+        if (ply > 0)
+        {
+            if (isRepetition(worker))
+                return 0;
+
+            // no line can be better than a mate on the next move
+            alpha = std::max(alpha, -cMateScore + ply);
+            beta = std::min(beta, cMateScore - ply - 1);
+            if (alpha >= beta)
+                return alpha;
+
+            if (ply >= cMaxPly - 1)
+                return Evaluate(board);
+        }
+
+        // extended before the table is probed, thus probes and stores use the same depth
+        Piece::Colour player = board.get_active_player();
+        bool in_check = board.isInCheck(player);
+        if (in_check)
+            depth++;
+
+        zobrist::Key key = board.get_key();
+        Move hash_move;
+
+        TranspositionTable::Entry entry;
+        if (m_transposition_table.Probe(key, entry))
+        {
+            hash_move = entry.move;
+            int score = ScoreFromTable(entry.score, ply);
+
+            // pv nodes are searched anyway, thus the pv can be read from the table afterwards
+            if (!is_pv_node && entry.depth >= depth &&
+                (entry.bound == TranspositionTable::Bound::Exact ||
+                 (entry.bound == TranspositionTable::Bound::Lower && score >= beta) ||
+                 (entry.bound == TranspositionTable::Bound::Upper && score <= alpha)))
+                return score;
+        }
+
+        // if passing the turn still fails high, a real move will too
+        // not without pieces, zugzwang is common in pawn endgames
+        if (!is_pv_node && !in_check && null_move_allowed && depth >= 3 && hasNonPawnMaterial(board, player) &&
+            Evaluate(board) >= beta)
+        {
+            int reduction = 2 + depth / 4;
+
+            Board::UndoInfo undo_info = board.MakeNullMove();
+            worker.keys.push_back(key);
+            int score = -AlphaBeta(worker, -beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+            worker.keys.pop_back();
+            board.UnmakeNullMove(undo_info);
+
+            if (m_stop.load(std::memory_order_relaxed))
+                return 0;
+            // an unproven mate
+            if (score >= beta)
+                return isMateScore(score) ? beta : score;
+        }
+
+        int original_alpha = alpha;
+        int best_score = -cInfinity;
+        Move best_move;
+        int move_count = 0;
+
+        std::array<Move, MovePicker::cNumKillers> &killers = worker.killers[ply];
+        MovePicker picker(board, hash_move, killers);
+
+        Move move;
+        while (picker.Next(move))
+        {
+            move_count++;
+            bool is_quiet = !move.isCapture() && !move.isPawnPromotion();
+
+            Board::UndoInfo undo_info = board.MakeMove(move);
+            worker.keys.push_back(key);
+
+            bool gives_check = board.isInCheck(board.get_active_player());
+            int new_depth = depth - 1;
+            int score;
+
+            // the first move is expected to be the best one, the others only have to be proven worse with a null window
+            if (move_count == 1)
+            {
+                score = -AlphaBeta(worker, -beta, -alpha, new_depth, ply + 1, true);
+            }
+            else
+            {
+                int reduction = 0;
+                if (depth >= 3 && move_count > 3 && is_quiet && !in_check && !gives_check)
+                {
+                    reduction = cReductions.table[std::min(depth, cMaxReducedDepth - 1)][std::min(move_count, cMaxReducedMoveCount - 1)];
+                    if (is_pv_node)
+                        reduction--;
+                    reduction = std::clamp(reduction, 0, new_depth - 1);
+                }
+
+                score = -AlphaBeta(worker, -alpha - 1, -alpha, new_depth - reduction, ply + 1, true);
+
+                if (score > alpha && reduction > 0)
+                    score = -AlphaBeta(worker, -alpha - 1, -alpha, new_depth, ply + 1, true);
+                if (score > alpha && score < beta)
+                    score = -AlphaBeta(worker, -beta, -alpha, new_depth, ply + 1, true);
+            }
+
+            worker.keys.pop_back();
+            board.UnmakeMove(undo_info);
+
+            if (m_stop.load(std::memory_order_relaxed))
+                return 0;
+
+            if (score <= best_score)
+                continue;
+
+            best_score = score;
+            best_move = move;
+            if (ply == 0)
+                worker.root_best_move = move;
+
+            if (score <= alpha)
+                continue;
+
+            alpha = score;
+            if (score >= beta)
+            {
+                if (is_quiet && !(killers[0] == move))
+                {
+                    killers[1] = killers[0];
+                    killers[0] = move;
+                }
+
+                break;
+            }
+        }
+
+        if (move_count == 0)
+            return in_check ? -cMateScore + ply : 0;
+
+        TranspositionTable::Bound bound = best_score >= beta             ? TranspositionTable::Bound::Lower
+                                          : best_score > original_alpha ? TranspositionTable::Bound::Exact
+                                                                        : TranspositionTable::Bound::Upper;
+        // after a fail low every move looks alike, the table keeps the move of an earlier search
+        m_transposition_table.Store(key, bound == TranspositionTable::Bound::Upper ? Move() : best_move,
+                                    ScoreToTable(best_score, ply), depth, bound);
+
+        return best_score;
+    }
+    int Search::Quiescence(Worker &worker, int alpha, int beta, const int &ply)
+    {
+        CheckLimits(worker);
+        if (m_stop.load(std::memory_order_relaxed))
+            return 0;
+
+        Board &board = worker.board;
+        if (ply >= cMaxPly - 1)
+            return Evaluate(board);
+
+        // a player in check has to answer it, every evasion is searched
+        bool in_check = board.isInCheck(board.get_active_player());
+        int best_score = -cInfinity;
+
+        // otherwise the player may stop capturing if the position is good enough already
+        if (!in_check)
+        {
+            best_score = Evaluate(board);
+            if (best_score >= beta)
+                return best_score;
+
+            alpha = std::max(alpha, best_score);
+        }
+
+        MovePicker picker = in_check ? MovePicker(board, Move(), {}) : MovePicker(board, Move());
+        int move_count = 0;
+
+        Move move;
+        while (picker.Next(move))
+        {
+            move_count++;
+
+            Board::UndoInfo undo_info = board.MakeMove(move);
+            int score = -Quiescence(worker, -beta, -alpha, ply + 1);
+            board.UnmakeMove(undo_info);
+
+            if (m_stop.load(std::memory_order_relaxed))
+                return 0;
+
+            if (score <= best_score)
+                continue;
+
+            best_score = score;
+            if (score <= alpha)
+                continue;
+
+            alpha = score;
+            if (score >= beta)
+                break;
+        }
+
+        if (in_check && move_count == 0)
+            return -cMateScore + ply;
+
+        return best_score;
+    }
+
+    int Search::Evaluate(const Board &board) const
+    {
+        // the evaluation must not be mistaken for a mate
+        return std::clamp(m_evaluation(board), -cMateBound + 1, cMateBound - 1);
+    }
+    bool Search::isRepetition(const Worker &worker) const
+    {
+        zobrist::Key key = worker.board.get_key();
+
+        // only positions with the same player to move can repeat
+        for (int i = (int)worker.keys.size() - 2; i >= 0; i -= 2)
+        {
+            if (worker.keys[i] == key)
+                return true;
+        }
+
+        return false;
+    }
+    void Search::CheckLimits(Worker &worker)
+    {
+        unsigned long long nodes = worker.nodes.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (worker.id != 0 || nodes % cCheckInterval != 0)
+            return;
+
+        if (m_limits.movetime.count() > 0 && get_seconds() * 1000 >= m_limits.movetime.count())
+            m_stop.store(true);
+        if (m_limits.nodes > 0 && get_nodes() >= m_limits.nodes)
+            m_stop.store(true);
+    }
+
+    SearchReport Search::MakeReport(const Worker &worker) const
+    {
+        SearchReport report;
+        report.depth = worker.completed_depth;
+        report.score = worker.best_score;
+        report.pv = ExtractPv(worker.board, worker.best_move, worker.completed_depth);
+        report.nodes = get_nodes();
+        report.seconds = get_seconds();
+        report.nodes_per_second = report.seconds > 0 ? (unsigned long long)(report.nodes / report.seconds) : 0;
+        report.hashfull = m_transposition_table.Hashfull();
+
+        return report;
+    }
+    std::vector<Move> Search::ExtractPv(const Board &board, const Move &best_move, const int &max_length) const
+    {
+        std::vector<Move> pv;
+        if (best_move == Move())
+            return pv;
+
+        // the rest of the pv are the best moves stored in the table, the entries may be overwritten or belong to
+        // other positions already, thus every move is checked
+        Board pv_board = board;
+        Move move = best_move;
+        while (true)
+        {
+            pv.push_back(move);
+            pv_board.MakeMove(move);
+
+            TranspositionTable::Entry entry;
+            if ((int)pv.size() >= std::max(max_length, 1) || !m_transposition_table.Probe(pv_board.get_key(), entry) ||
+                entry.move == Move() || !pv_board.isLegal(entry.move))
+                break;
+
+            move = entry.move;
+        }
+
+        return pv;
+    }
+    unsigned long long Search::get_nodes() const
+    {
+        unsigned long long nodes = 0;
+        for (const std::unique_ptr<Worker> &worker : m_workers)
+            nodes += worker->nodes.load(std::memory_order_relaxed);
+
+        return nodes;
+    }
+    double Search::get_seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+    int Search::ScoreToTable(const int &score, const int &ply)
+    {
+        if (score >= cMateBound)
+            return score + ply;
+        if (score <= -cMateBound)
+            return score - ply;
+
+        return score;
+    }
+    int Search::ScoreFromTable(const int &score, const int &ply)
+    {
+        if (score >= cMateBound)
+            return score - ply;
+        if (score <= -cMateBound)
+            return score + ply;
+
+        return score;
+    }
+} // namespace chess
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "chess_lib/transposition_table.h"
+
+#include <bit>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+namespace chess
+{
+    namespace
+    {
+        const std::size_t cHugePageSize = 2 * 1024 * 1024;
+        const unsigned int cAgeMask = 63;
+    } // namespace
+
+    TranspositionTable::TranspositionTable(const std::size_t &size_mb, const bool &use_huge_pages) : m_buckets(nullptr),
+                                                                                                  m_num_buckets(0),
+                                                                                                  m_size_bytes(0),
+                                                                                                  m_uses_huge_pages(false),
+                                                                                                  m_age(0)
+    {
+        if (size_mb == 0)
+            throw std::invalid_argument("transposition table needs at least 1 MB!");
+
+        m_num_buckets = std::bit_floor(size_mb * 1024 * 1024 / cBucketSize);
+        m_size_bytes = m_num_buckets * cBucketSize;
+
+        void *data = MAP_FAILED;
+
+        // explicit huge pages need a multiple of the huge page size and fail if none are reserved
+        if (use_huge_pages)
+        {
+            std::size_t huge_page_size_bytes = (m_size_bytes + cHugePageSize - 1) / cHugePageSize * cHugePageSize;
+            data = mmap(nullptr, huge_page_size_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+            if (data != MAP_FAILED)
+            {
+                m_size_bytes = huge_page_size_bytes;
+                m_uses_huge_pages = true;
+            }
+        }
+
+        if (data == MAP_FAILED)
+        {
+            data = mmap(nullptr, m_size_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED)
+                throw std::runtime_error("failed to allocate " + std::to_string(size_mb) + " MB for the transposition table!");
+
+            if (use_huge_pages)
+                m_uses_huge_pages = madvise(data, m_size_bytes, MADV_HUGEPAGE) == 0;
+        }
+
+        // anonymous mappings are zeroed, thus every entry starts out empty (Bound::None)
+        m_buckets = static_cast<Bucket *>(data);
+    }
+    TranspositionTable::~TranspositionTable()
+    {
+        munmap(m_buckets, m_size_bytes);
+    }
+
+    bool TranspositionTable::Probe(const zobrist::Key &key, Entry &entry) const
+    {
+        const Bucket &bucket = m_buckets[key & (m_num_buckets - 1)];
+
+        for (const Slot &slot : bucket.slots)
+        {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if ((slot.key_xor_data.load(std::memory_order_relaxed) ^ data) != key)
+                continue;
+
+            entry = Unpack(data);
+            return entry.bound != Bound::None;
+        }
+
+        return false;
+    }
+    void TranspositionTable::Store(const zobrist::Key &key, const Move &move, const int &score, const int &depth, const Bound &bound)
+    {
+        Bucket &bucket = m_buckets[key & (m_num_buckets - 1)];
+        unsigned int age = m_age.load(std::memory_order_relaxed) & cAgeMask;
+
+        Slot *replaced_slot = &bucket.slots[0];
+        Move stored_move = move;
+
+        // the same position is always overwritten, otherwise the shallowest entry, preferring entries of earlier searches
+        int lowest_worth = std::numeric_limits<int>::max();
+        for (Slot &slot : bucket.slots)
+        {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            Entry entry = Unpack(data);
+
+            if ((slot.key_xor_data.load(std::memory_order_relaxed) ^ data) == key)
+            {
+                // a search without best move (fail low) keeps the move of the earlier one
+                if (move == Move())
+                    stored_move = entry.move;
+
+                replaced_slot = &slot;
+                break;
+            }
+
+            int worth = entry.bound == Bound::None ? std::numeric_limits<int>::min()
+                                                   : entry.depth - 8 * (int)((age - get_age(data)) & cAgeMask);
+            if (worth < lowest_worth)
+            {
+                lowest_worth = worth;
+                replaced_slot = &slot;
+            }
+        }
+
+        std::uint64_t data = Pack(stored_move, score, depth, bound, age);
+        replaced_slot->key_xor_data.store(key ^ data, std::memory_order_relaxed);
+        replaced_slot->data.store(data, std::memory_order_relaxed);
+    }
+
+    void TranspositionTable::NewSearch()
+    {
+        m_age.fetch_add(1, std::memory_order_relaxed);
+    }
+    void TranspositionTable::Clear()
+    {
+        for (std::size_t i = 0; i < m_num_buckets; i++)
+        {
+            for (Slot &slot : m_buckets[i].slots)
+            {
+                slot.key_xor_data.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        m_age.store(0, std::memory_order_relaxed);
+    }
+
+    unsigned int TranspositionTable::Hashfull() const
+    {
+        std::size_t num_sampled_buckets = std::min<std::size_t>(1000, m_num_buckets);
+        unsigned int age = m_age.load(std::memory_order_relaxed) & cAgeMask;
+        unsigned int num_filled = 0;
+
+        for (std::size_t i = 0; i < num_sampled_buckets; i++)
+        {
+            for (const Slot &slot : m_buckets[i].slots)
+            {
+                std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+                if (Unpack(data).bound != Bound::None && get_age(data) == age)
+                    num_filled++;
+            }
+        }
+
+        return num_filled * 1000 / (num_sampled_buckets * cEntriesPerBucket);
+    }
+
+    std::size_t TranspositionTable::get_size_bytes() const
+    {
+        return m_size_bytes;
+    }
+    bool TranspositionTable::get_uses_huge_pages() const
+    {
+        return m_uses_huge_pages;
+    }
+
+    std::uint64_t TranspositionTable::Pack(const Move &move, const int &score, const int &depth, const Bound &bound, const unsigned int &age)
+    {
+        std::uint64_t packed_move = move.get_data();
+        std::uint64_t packed_score = (std::uint16_t)(std::int16_t)score;
+        std::uint64_t packed_depth = (std::uint8_t)std::clamp(depth, 0, 255);
+
+        return packed_move | packed_score << 16 | packed_depth << 32 | (std::uint64_t)bound << 40 | (std::uint64_t)age << 42;
+    }
+    TranspositionTable::Entry TranspositionTable::Unpack(const std::uint64_t &data)
+    {
+        return {Move::FromData(data & 0xFFFF),
+                (std::int16_t)(data >> 16 & 0xFFFF),
+                (int)(data >> 32 & 0xFF),
+                (Bound)(data >> 40 & 3)};
+    }
+    unsigned int TranspositionTable::get_age(const std::uint64_t &data)
+    {
+        return data >> 42 & cAgeMask;
+    }
+} // namespace chess
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef ML_ACCUMULATOR_HEADER_GUARD
+#define ML_ACCUMULATOR_HEADER_GUARD
+
+#include <vector>
+#include <utility> // for std::pair
+#include <algorithm> // for std::copy
+#include <stdexcept>
+
+#include "tensor.h"
+#include "sparse_tensor.h"
+#include "model.h"
+
+namespace ml_lib
+{
+    // keeps the pre-activations (W * x + b) of a Linear layer for a binary input x
+    // which only changes by a few active elements at a time
+    // instead of recomputing W * x the weight columns of the changed elements get added or subtracted
+    class Accumulator
+    {
+    public:
+        Accumulator(const layer_type::Linear *layer);
+
+        // the accumulator has to be refreshed after linking a new layer
+        void Link(const layer_type::Linear *layer);
+        void Refresh(const SparseTensor &input);
+
+        void AddFeature(const unsigned int &index);
+        void RemoveFeature(const unsigned int &index);
+
+        // Push starts a new undo frame, Pop reverts all feature changes since the last Push
+        void Push();
+        void Pop();
+        unsigned int get_num_undo_frames() const;
+
+        Tensor get_pre_activations() const;
+        // writes the pre-activations into one column of a batch, without allocating a tensor
+        void CopyPreActivations(double *destination) const;
+
+    private:
+        void AccumulateColumn(const unsigned int &index, const double &sign);
+
+        const layer_type::Linear *m_layer;
+        std::vector<double> m_pre_activations;
+
+        // per frame: changed feature index and the sign it was accumulated with
+        std::vector<std::vector<std::pair<unsigned int, double>>> m_undo_frames;
+    };
+} // namespace ml_lib
+
+#endif // !ML_ACCUMULATOR_HEADER_GUARD
\ No newline at end of file
@@ -0,0 +1,136 @@
+#ifndef ML_CHECKPOINT_HEADER_GUARD
+#define ML_CHECKPOINT_HEADER_GUARD
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "tensor.h"
+#include "model.h"
+
+namespace ml_lib
+{
+    namespace checkpoint
+    {
+        // file layout (native byte order):
+        // Header | TensorEntry * num_tensors | raw double blobs, each aligned to cAlignment bytes
+        // the blobs can be used in place after mapping the file into memory
+        const char cMagic[8] = {'M', 'L', 'C', 'K', 'P', 'T', '\0', '\0'};
+        const std::uint32_t cVersion = 1U;
+        const std::uint64_t cAlignment = 64U;
+        const unsigned int cMaxDimensions = 4U;
+
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t num_tensors;
+            std::uint64_t table_offset;
+            std::uint64_t file_size;
+            char reserved[32];
+        };
+        struct TensorEntry
+        {
+            char name[24];
+            std::uint32_t dimensions;
+            std::uint32_t shape[cMaxDimensions];
+            std::uint32_t reserved;
+            std::uint64_t data_offset;
+            std::uint64_t num_elements;
+        };
+        static_assert(sizeof(Header) == cAlignment, "checkpoint header needs to fill one alignment block");
+        static_assert(sizeof(TensorEntry) == cAlignment, "checkpoint tensor entry needs to fill one alignment block");
+
+        // plain copy of a tensor's values
+        struct TensorRecord
+        {
+            std::string name;
+            std::vector<unsigned int> shape;
+            std::vector<double> values;
+        };
+
+        std::vector<Tensor *> CollectParameters(const std::vector<LayerBase *> &model_layers);
+        std::vector<TensorRecord> Snapshot(const std::vector<Tensor *> &parameters, const std::string &name_prefix = "parameter");
+
+        void Write(const std::string &path, const std::vector<TensorRecord> &records, const bool &sync = false);
+        void Save(const std::string &path, const std::vector<LayerBase *> &model_layers);
+
+        class MappedCheckpoint
+        {
+        public:
+            MappedCheckpoint(const std::string &path);
+            MappedCheckpoint(const MappedCheckpoint &obj) = delete;
+            ~MappedCheckpoint();
+
+            unsigned int get_num_tensors() const;
+            std::string get_name(const unsigned int &tensor_index) const;
+            std::vector<unsigned int> get_shape(const unsigned int &tensor_index) const;
+            const double *get_data(const unsigned int &tensor_index) const;
+
+        private:
+            const TensorEntry &get_entry(const unsigned int &tensor_index) const;
+
+            void *m_mapping;
+            std::uint64_t m_size;
+            const Header *m_header;
+            const TensorEntry *m_table;
+        };
+
+        void Load(const MappedCheckpoint &checkpoint, const std::vector<LayerBase *> &model_layers, const std::string &name_prefix = "parameter");
+        void Load(const std::string &path, const std::vector<LayerBase *> &model_layers, const std::string &name_prefix = "parameter");
+
+        // writes checkpoints on a background thread while training continues
+        // the training thread only copies the parameter values into a staging buffer
+        // every checkpoint is written to a temporary file, synced and renamed, only the last num_kept_checkpoints (at least 1) are kept
+        // a checkpoint is due after interval_games games or interval_seconds seconds, an interval of 0 disables its trigger
+        // a writer on an existing path_prefix continues the numbering of the checkpoints found there and prunes them too
+        class AsyncWriter
+        {
+        public:
+            AsyncWriter(const std::string &path_prefix, const unsigned int &num_kept_checkpoints, const unsigned int &interval_games, const double &interval_seconds);
+            AsyncWriter(const AsyncWriter &obj) = delete;
+            ~AsyncWriter();
+
+            void Track(const std::string &name_prefix, const std::vector<Tensor *> &parameters);
+
+            // returns true if a checkpoint is due and has been handed to the background thread
+            bool GameFinished();
+            void Save();
+            void Flush();
+
+        private:
+            void Run();
+
+            std::string m_path_prefix;
+            unsigned int m_num_kept_checkpoints;
+            unsigned int m_interval_games;
+            std::chrono::duration<double> m_interval_seconds;
+
+            std::vector<std::pair<std::string, std::vector<Tensor *>>> m_tracked_parameters;
+
+            unsigned int m_games_since_checkpoint;
+            std::chrono::steady_clock::time_point m_last_checkpoint_time;
+            unsigned int m_next_checkpoint_id;
+
+            // staging buffer, handed from the training thread to the background thread
+            std::vector<TensorRecord> m_staging_records;
+            std::string m_staging_path;
+            bool m_staging_full;
+            bool m_writing;
+            bool m_stop;
+
+            std::deque<std::string> m_written_paths;
+
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::thread m_thread;
+        };
+    } // namespace checkpoint
+} // namespace ml_lib
+
+#endif // !ML_CHECKPOINT_HEADER_GUARD
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include <random>
 #include <array>
 #include <unordered_set>
+#include <memory>
 
 #include "tensor.h"
+#include "sparse_tensor.h"
 
 namespace ml_lib
 {
@@ -34,7 +36,11 @@ namespace ml_lib
         virtual ~LayerBase() = default;
 
         virtual Tensor FeedForward(const Tensor &input) const = 0;
+        virtual Tensor FeedForward(const SparseTensor &input) const { return FeedForward(input.ToDense()); };
         virtual void LinkLearnableParameter(OptimizerBase *optimizer) { };
+
+        // copy of the layer without autodiff dependencies, used for inference on other threads
+        virtual std::unique_ptr<LayerBase> Detach() const = 0;
     };
     namespace layer_type
     {
@@ -45,9 +51,19 @@ namespace ml_lib
             ~Linear() override = default;
 
             Tensor FeedForward(const Tensor &input) const override;
+            Tensor FeedForward(const SparseTensor &input) const override;
             void LinkLearnableParameter(OptimizerBase *optimizer) override;
+
+            unsigned int get_input_dimensions() const;
+            unsigned int get_output_dimensions() const;
+            double get_weight(const unsigned int &output_index, const unsigned int &input_index) const;
+            double get_bias(const unsigned int &output_index) const;
+
+            std::unique_ptr<LayerBase> Detach() const override;
         
         private:
+            Linear(const Tensor &weight_matrix, const Tensor &bias_vector);
+
             Tensor m_weight_matrix;
             Tensor m_bias_vector;
         };
@@ -63,6 +79,7 @@ namespace ml_lib
 
             Tensor FeedForward(const Tensor &input) const override;
             void LinkLearnableParameter(OptimizerBase *optimizer) override { };
+            std::unique_ptr<LayerBase> Detach() const override;
 
         private:
             unsigned int m_axis;
@@ -79,6 +96,7 @@ namespace ml_lib
 
             Tensor FeedForward(const Tensor& input) const override;
             void LinkLearnableParameter(OptimizerBase *optimizer) override { };
+            std::unique_ptr<LayerBase> Detach() const override;
         };
         class Relu : public LayerBase
         {
@@ -106,6 +124,8 @@ namespace ml_lib
 
             virtual void Step(Tensor loss) override;
             virtual void Link(Tensor* learnable_parameter) override;
+
+            std::vector<Tensor *> get_learnable_parameters() const;
         private:
             Tensor m_learning_rate;
             std::vector<Tensor *> m_learnable_parameters;
@@ -0,0 +1,190 @@
+#ifndef ML_MPMC_QUEUE_HEADER_GUARD
+#define ML_MPMC_QUEUE_HEADER_GUARD
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <utility> // for std::move
+#include <stdexcept>
+
+namespace ml_lib
+{
+    // bounded lock-free multi-producer/multi-consumer ring queue
+    // every cell carries a sequence number which tells producers and consumers whose turn it is:
+    //   sequence == position:     cell is free for the producer of position
+    //   sequence == position + 1: cell holds the element for the consumer of position
+    // producers and consumers only synchronize through the cell they claimed, no lock is taken
+    template <typename T>
+    class MpmcQueue
+    {
+    public:
+        static constexpr std::size_t cCacheLineSize = 64;
+
+        // capacity has to be a power of two
+        MpmcQueue(const std::size_t &capacity) : m_capacity_mask(capacity - 1),
+                                                 m_cells(capacity),
+                                                 m_enqueue_position(0),
+                                                 m_dequeue_position(0),
+                                                 m_num_drops(0)
+        {
+            if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+                throw std::invalid_argument("capacity needs to be a power of two!");
+
+            for (std::size_t i = 0; i < capacity; i++)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        MpmcQueue(const MpmcQueue &obj) = delete;
+
+        // returns false (and counts a drop) if the queue is full
+        bool TryPush(T value)
+        {
+            if (Enqueue(value))
+                return true;
+
+            m_num_drops.value.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        bool TryPop(T &value)
+        {
+            return Dequeue(value);
+        }
+
+        // backpressure: producers wait until a consumer made room
+        void Push(T value)
+        {
+            for (unsigned int attempt = 0; !Enqueue(value); attempt++)
+                Backoff(attempt);
+        }
+        T Pop()
+        {
+            T value;
+
+            for (unsigned int attempt = 0; !Dequeue(value); attempt++)
+                Backoff(attempt);
+
+            return value;
+        }
+
+        // approximate while other threads push or pop
+        std::size_t get_depth() const
+        {
+            std::size_t enqueue_position = m_enqueue_position.value.load(std::memory_order_relaxed);
+            std::size_t dequeue_position = m_dequeue_position.value.load(std::memory_order_relaxed);
+
+            return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+        }
+        std::size_t get_num_drops() const
+        {
+            return m_num_drops.value.load(std::memory_order_relaxed);
+        }
+        std::size_t get_capacity() const
+        {
+            return m_capacity_mask + 1;
+        }
+
+    private:
+        struct alignas(cCacheLineSize) Cell
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        // keeps producer and consumer positions on separate cache lines (no false sharing)
+        struct alignas(cCacheLineSize) PaddedCounter
+        {
+            PaddedCounter(const std::size_t &initial_value) : value(initial_value)
+            {
+            }
+
+            std::atomic<std::size_t> value;
+        };
+
+        bool Enqueue(T &value)
+        {
+            std::size_t position = m_enqueue_position.value.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                Cell &cell = m_cells[position & m_capacity_mask];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+
+                if (difference == 0)
+                {
+                    // cell is free, try to claim position
+                    if (m_enqueue_position.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // cell still holds the element of the previous round: full
+                    return false;
+                }
+                else
+                {
+                    // another producer claimed position
+                    position = m_enqueue_position.value.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        bool Dequeue(T &value)
+        {
+            std::size_t position = m_dequeue_position.value.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                Cell &cell = m_cells[position & m_capacity_mask];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)(position + 1);
+
+                if (difference == 0)
+                {
+                    // cell is filled, try to claim position
+                    if (m_dequeue_position.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(cell.value);
+                        cell.sequence.store(position + m_capacity_mask + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // producer has not filled the cell yet: empty
+                    return false;
+                }
+                else
+                {
+                    // another consumer claimed position
+                    position = m_dequeue_position.value.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        static void Backoff(const unsigned int &attempt)
+        {
+            // spin shortly, then give the cpu away
+            static const unsigned int cNumSpins = 64;
+
+            if (attempt < cNumSpins)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        const std::size_t m_capacity_mask;
+        std::vector<Cell> m_cells;
+
+        PaddedCounter m_enqueue_position;
+        PaddedCounter m_dequeue_position;
+        PaddedCounter m_num_drops;
+    };
+} // namespace ml_lib
+
+#endif // !ML_MPMC_QUEUE_HEADER_GUARD
\ No newline at end of file
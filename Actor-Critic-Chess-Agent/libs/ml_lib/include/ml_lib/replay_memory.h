@@ -2,10 +2,13 @@
 #define ML_REPLAY_MEMORY_HEADER_GUARD
 
 #include <vector>
+#include <array>
 #include <unordered_set>
+#include <mutex>
 
 namespace ml_lib
 {
+    // Put and GenerateRandomBatch may be called from several threads at once
     template <typename T>
     class ReplayMemory
     {
@@ -24,6 +27,8 @@ namespace ml_lib
 
         void Put(const T &state_action_pair)
         {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
             m_state_action_pairs[m_position] = state_action_pair;
 
             m_cur_num_elements = std::min((m_cur_num_elements + 1), m_max_elements);
@@ -33,6 +38,8 @@ namespace ml_lib
         template <int BATCH_SIZE>
         T GenerateRandomBatch()
         {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
             if(BATCH_SIZE > (int)m_cur_num_elements)
                 throw;
 
@@ -49,6 +56,13 @@ namespace ml_lib
             return batch;
         }
 
+        unsigned int get_num_elements()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_cur_num_elements;
+        }
+
     private:
         template <int BATCH_SIZE>
         static std::array<int, BATCH_SIZE> GenerateRandomBatchIndexies(int max_index)
@@ -77,6 +91,8 @@ namespace ml_lib
         unsigned int m_position;
 
         T *m_state_action_pairs;
+
+        std::mutex m_mutex;
     };
 } // namespace ml_lib
 
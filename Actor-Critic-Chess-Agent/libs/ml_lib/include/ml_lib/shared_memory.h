@@ -0,0 +1,106 @@
+#ifndef ML_SHARED_MEMORY_HEADER_GUARD
+#define ML_SHARED_MEMORY_HEADER_GUARD
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <atomic>
+
+namespace ml_lib
+{
+    namespace shared_memory
+    {
+        const std::size_t cCacheLineSize = 64;
+
+        // named POSIX shared memory object (shm_open + mmap)
+        // the creating process unlinks the name again on destruction
+        class Region
+        {
+        public:
+            static Region Create(const std::string &name, const std::size_t &size);
+            static Region Open(const std::string &name);
+
+            Region(const Region &obj) = delete;
+            Region(Region &&obj) noexcept;
+            ~Region();
+
+            void *get_data() const;
+            std::size_t get_size() const;
+            std::string get_name() const;
+
+        private:
+            Region(const std::string &name, void *data, const std::size_t &size, const bool &owner);
+
+            std::string m_name;
+            void *m_data;
+            std::size_t m_size;
+            bool m_owner;
+        };
+
+        // bounded multi-producer/multi-consumer ring of byte messages inside shared memory
+        // same sequence number protocol as MpmcQueue, but with fixed size slots and no pointers,
+        // thus every process can map the ring at a different address
+        // a process dying between claiming and publishing a slot blocks the ring at that slot
+        class Ring
+        {
+        public:
+            static std::size_t RequiredSize(const std::size_t &capacity, const std::size_t &slot_size);
+
+            // capacity has to be a power of two, memory has to be cache line aligned
+            static Ring Initialize(void *memory, const std::size_t &capacity, const std::size_t &slot_size);
+            static Ring Attach(void *memory);
+
+            // returns false (and counts a drop) if the ring is full
+            bool TryPush(const void *message, const std::size_t &size);
+            bool TryPop(std::vector<unsigned char> &message);
+
+            // backpressure: waits until a consumer made room
+            void Push(const void *message, const std::size_t &size);
+
+            std::size_t get_depth() const;
+            std::size_t get_num_drops() const;
+            std::size_t get_slot_size() const;
+
+        private:
+            struct Header;
+            struct SlotHeader;
+
+            Ring(Header *header);
+
+            bool Enqueue(const void *message, const std::size_t &size);
+            SlotHeader *get_slot(const std::uint64_t &position) const;
+
+            Header *m_header;
+        };
+
+        // one writer publishes an array of doubles, any number of readers copy it without blocking the writer
+        // readers retry if the sequence number changed (or was odd) while they copied
+        class Seqlock
+        {
+        public:
+            static std::size_t RequiredSize(const std::size_t &num_values);
+
+            static Seqlock Initialize(void *memory, const std::size_t &num_values);
+            static Seqlock Attach(void *memory);
+
+            void Write(const double *values);
+
+            // returns false if the writer interfered, version: number of completed writes
+            bool TryRead(double *values, std::uint64_t &version) const;
+            std::uint64_t get_version() const;
+            std::size_t get_num_values() const;
+
+        private:
+            struct Header;
+
+            Seqlock(Header *header);
+
+            double *get_values() const;
+
+            Header *m_header;
+        };
+    } // namespace shared_memory
+} // namespace ml_lib
+
+#endif // !ML_SHARED_MEMORY_HEADER_GUARD
\ No newline at end of file
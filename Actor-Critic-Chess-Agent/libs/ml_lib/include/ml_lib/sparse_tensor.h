@@ -0,0 +1,52 @@
+#ifndef ML_SPARSE_TENSOR_HEADER_GUARD
+#define ML_SPARSE_TENSOR_HEADER_GUARD
+
+#include <vector> // for std::vector
+#include <functional> // for std::function
+
+#include "tensor.h"
+
+namespace ml_lib
+{
+    // two dimensional tensor {num_rows, batchsize} which only stores its active elements
+    // binary elements are implicitly 1 and carry no gradient (one-hot encodings)
+    // valued elements keep their value and their autodiff dependency
+    class SparseTensor
+    {
+    public:
+        static SparseTensor Empty();
+
+        SparseTensor(const unsigned int &num_rows, const std::vector<std::vector<unsigned int>> &active_indices);
+
+        static SparseTensor FromDense(const Tensor &dense);
+        static SparseTensor Gather(const Tensor &dense, const SparseTensor &support);
+        static SparseTensor Concatenate(const SparseTensor &a, const SparseTensor &b, unsigned int axis);
+
+        SparseTensor Remap(const std::function<unsigned int(const unsigned int &)> &index_func) const;
+        Tensor ToDense() const;
+
+        unsigned int get_num_rows() const;
+        unsigned int get_batchsize() const;
+        unsigned int get_num_active_elements() const;
+        std::vector<unsigned int> get_active_indices(const unsigned int &batch_index) const;
+
+    private:
+        friend class Tensor;
+
+        SparseTensor(const unsigned int &num_rows,
+                     const std::vector<std::vector<unsigned int>> &binary_indices,
+                     const std::vector<std::vector<unsigned int>> &valued_indices,
+                     const Tensor &values);
+
+        unsigned int m_num_rows;
+
+        // one index list per batch element
+        std::vector<std::vector<unsigned int>> m_binary_indices;
+        std::vector<std::vector<unsigned int>> m_valued_indices;
+
+        // values of all valued elements, ordered by batch element
+        Tensor m_values;
+    };
+} // namespace ml_lib
+
+#endif // !ML_SPARSE_TENSOR_HEADER_GUARD
\ No newline at end of file
@@ -13,6 +13,8 @@
 
 namespace ml_lib
 {
+    class SparseTensor;
+
     class Tensor
     {
     public:
@@ -32,6 +34,7 @@ namespace ml_lib
         void SetElementValues(const double *new_values);
 
         double get_element_value_at(const int& index) const;
+        void CopyElementValues(double *destination) const;
         unsigned int get_dimensions() const;
         std::vector<unsigned int> get_shape() const;
         unsigned int get_num_elements() const;
@@ -39,6 +42,7 @@ namespace ml_lib
 
         Tensor Grad() const;
         void Backward();
+        Tensor Detach() const;
 
         Tensor &operator=(const Tensor &other);
         Tensor &operator=(Tensor &&other) noexcept;
@@ -54,6 +58,7 @@ namespace ml_lib
         Tensor HadamardMult(const Tensor &other) const;
         Tensor ScalarMult(const Tensor &scalar) const;
         Tensor MatrixMult(const Tensor &other) const;
+        Tensor MatrixMult(const SparseTensor &other) const;
         
         Tensor Conv2d() const;
         
@@ -61,6 +66,8 @@ namespace ml_lib
         Tensor Repeat(const unsigned int &axis, const unsigned int &repetitions) const;
         Tensor Reshape(const std::vector<unsigned int>& shape) const;
         static Tensor Concatenate(const Tensor& a, const Tensor& b, unsigned int axis);
+        Tensor Gather(const std::vector<unsigned int>& indices) const;
+        static Tensor Scatter(const Tensor& values, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& shape);
         unsigned int ArgFind(const std::function< bool(const double&)>& find_func) const;
         
         unsigned int PositionToIndex(const std::vector<unsigned int>& position) const;
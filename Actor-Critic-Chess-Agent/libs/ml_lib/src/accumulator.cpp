@@ -0,0 +1,86 @@
+#include "ml_lib/accumulator.h"
+
+namespace ml_lib
+{
+    Accumulator::Accumulator(const layer_type::Linear *layer) : m_layer(layer),
+                                                                m_pre_activations(layer->get_output_dimensions(), 0.),
+                                                                m_undo_frames()
+    {
+    }
+
+    void Accumulator::Link(const layer_type::Linear *layer)
+    {
+        m_layer = layer;
+        m_pre_activations.assign(layer->get_output_dimensions(), 0.);
+        m_undo_frames.clear();
+    }
+    void Accumulator::Refresh(const SparseTensor &input)
+    {
+        // recompute from scratch, e.g. after a reset or after the weights have been trained
+        if (input.get_num_rows() != m_layer->get_input_dimensions() || input.get_batchsize() != 1)
+            throw;
+
+        for (unsigned int i = 0; i < m_pre_activations.size(); i++)
+            m_pre_activations[i] = m_layer->get_bias(i);
+
+        for (const unsigned int &index : input.get_active_indices(0))
+            AccumulateColumn(index, 1.);
+
+        m_undo_frames.clear();
+    }
+
+    void Accumulator::AddFeature(const unsigned int &index)
+    {
+        AccumulateColumn(index, 1.);
+
+        if (m_undo_frames.size() > 0)
+            m_undo_frames.back().push_back({index, 1.});
+    }
+    void Accumulator::RemoveFeature(const unsigned int &index)
+    {
+        AccumulateColumn(index, -1.);
+
+        if (m_undo_frames.size() > 0)
+            m_undo_frames.back().push_back({index, -1.});
+    }
+
+    void Accumulator::Push()
+    {
+        m_undo_frames.push_back({});
+    }
+    void Accumulator::Pop()
+    {
+        if (m_undo_frames.size() == 0)
+            throw std::logic_error("no frame to undo!");
+
+        std::vector<std::pair<unsigned int, double>> &frame = m_undo_frames.back();
+
+        // revert in reverse order
+        for (auto it = frame.rbegin(); it != frame.rend(); it++)
+            AccumulateColumn(it->first, -it->second);
+
+        m_undo_frames.pop_back();
+    }
+    unsigned int Accumulator::get_num_undo_frames() const
+    {
+        return m_undo_frames.size();
+    }
+
+    Tensor Accumulator::get_pre_activations() const
+    {
+        return Tensor({(unsigned int)m_pre_activations.size(), 1}, m_pre_activations.data());
+    }
+    void Accumulator::CopyPreActivations(double *destination) const
+    {
+        std::copy(m_pre_activations.begin(), m_pre_activations.end(), destination);
+    }
+
+    void Accumulator::AccumulateColumn(const unsigned int &index, const double &sign)
+    {
+        if (index >= m_layer->get_input_dimensions())
+            throw std::invalid_argument("index out of bounds!");
+
+        for (unsigned int i = 0; i < m_pre_activations.size(); i++)
+            m_pre_activations[i] += sign * m_layer->get_weight(i, index);
+    }
+} // namespace ml_lib
\ No newline at end of file
@@ -0,0 +1,444 @@
+#include "ml_lib/checkpoint.h"
+
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ml_lib
+{
+    namespace checkpoint
+    {
+        namespace
+        {
+            // collects the learnable parameters the same way an optimizer links them
+            class ParameterCollector : public OptimizerBase
+            {
+            public:
+                void Step([[maybe_unused]] Tensor loss) override { throw std::logic_error("ParameterCollector can't step!"); };
+                void Link(Tensor *learnable_parameter) override { m_parameters.push_back(learnable_parameter); };
+
+                std::vector<Tensor *> m_parameters;
+            };
+
+            std::uint64_t Align(const std::uint64_t &offset)
+            {
+                return (offset + cAlignment - 1) / cAlignment * cAlignment;
+            }
+
+            void WriteAll(const int &fd, const void *buffer, std::uint64_t size)
+            {
+                const char *bytes = (const char *)buffer;
+
+                while (size > 0)
+                {
+                    ssize_t written = write(fd, bytes, size);
+                    if (written < 0)
+                        throw std::runtime_error("failed to write checkpoint!");
+
+                    bytes += written;
+                    size -= written;
+                }
+            }
+
+            void SyncDirectory(const std::string &path)
+            {
+                std::filesystem::path parent = std::filesystem::path(path).parent_path();
+                std::string directory = parent.empty() ? "." : parent.string();
+
+                int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+                if (fd < 0)
+                    throw std::runtime_error("failed to open " + directory + "!");
+
+                int result = fsync(fd);
+                close(fd);
+
+                if (result != 0)
+                    throw std::runtime_error("failed to sync " + directory + "!");
+            }
+        } // namespace
+
+        std::vector<Tensor *> CollectParameters(const std::vector<LayerBase *> &model_layers)
+        {
+            ParameterCollector collector;
+
+            for (LayerBase *layer : model_layers)
+            {
+                layer->LinkLearnableParameter(&collector);
+            }
+
+            return collector.m_parameters;
+        }
+        std::vector<TensorRecord> Snapshot(const std::vector<Tensor *> &parameters, const std::string &name_prefix)
+        {
+            std::vector<TensorRecord> records(parameters.size());
+
+            for (unsigned int i = 0; i < parameters.size(); i++)
+            {
+                records[i].name = name_prefix + std::to_string(i);
+                records[i].shape = parameters[i]->get_shape();
+                records[i].values.resize(parameters[i]->get_num_elements());
+
+                parameters[i]->CopyElementValues(records[i].values.data());
+            }
+
+            return records;
+        }
+
+        void Write(const std::string &path, const std::vector<TensorRecord> &records, const bool &sync)
+        {
+            Header header = {};
+            std::memcpy(header.magic, cMagic, sizeof(cMagic));
+            header.version = cVersion;
+            header.num_tensors = records.size();
+            header.table_offset = sizeof(Header);
+
+            std::vector<TensorEntry> table(records.size());
+            std::uint64_t data_offset = Align(sizeof(Header) + records.size() * sizeof(TensorEntry));
+
+            for (unsigned int i = 0; i < records.size(); i++)
+            {
+                const TensorRecord &record = records[i];
+                TensorEntry &entry = table[i];
+
+                if (record.name.size() >= sizeof(entry.name) || record.shape.size() > cMaxDimensions)
+                    throw std::invalid_argument("tensor can't be stored in checkpoint!");
+
+                std::memset(&entry, 0, sizeof(TensorEntry));
+                std::memcpy(entry.name, record.name.c_str(), record.name.size());
+                entry.dimensions = record.shape.size();
+                for (unsigned int j = 0; j < record.shape.size(); j++)
+                    entry.shape[j] = record.shape[j];
+                entry.data_offset = data_offset;
+                entry.num_elements = record.values.size();
+
+                data_offset = Align(data_offset + entry.num_elements * sizeof(double));
+            }
+
+            header.file_size = data_offset;
+
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                throw std::runtime_error("failed to open " + path + "!");
+
+            try
+            {
+                static const char cPadding[cAlignment] = {};
+                std::uint64_t position = 0;
+
+                WriteAll(fd, &header, sizeof(Header));
+                WriteAll(fd, table.data(), table.size() * sizeof(TensorEntry));
+                position += sizeof(Header) + table.size() * sizeof(TensorEntry);
+
+                for (unsigned int i = 0; i < records.size(); i++)
+                {
+                    WriteAll(fd, cPadding, table[i].data_offset - position);
+                    WriteAll(fd, records[i].values.data(), records[i].values.size() * sizeof(double));
+                    position = table[i].data_offset + records[i].values.size() * sizeof(double);
+                }
+
+                WriteAll(fd, cPadding, header.file_size - position);
+
+                if (sync && fsync(fd) != 0)
+                    throw std::runtime_error("failed to sync " + path + "!");
+            }
+            catch (...)
+            {
+                close(fd);
+                throw;
+            }
+
+            close(fd);
+        }
+        void Save(const std::string &path, const std::vector<LayerBase *> &model_layers)
+        {
+            Write(path, Snapshot(CollectParameters(model_layers)));
+        }
+
+        MappedCheckpoint::MappedCheckpoint(const std::string &path) : m_mapping(nullptr),
+                                                                      m_size(0U),
+                                                                      m_header(nullptr),
+                                                                      m_table(nullptr)
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("failed to open " + path + "!");
+
+            struct stat file_status;
+            if (fstat(fd, &file_status) != 0 || (std::uint64_t)file_status.st_size < sizeof(Header))
+            {
+                close(fd);
+                throw std::runtime_error(path + " is not a checkpoint!");
+            }
+
+            m_size = file_status.st_size;
+            m_mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+
+            if (m_mapping == MAP_FAILED)
+                throw std::runtime_error("failed to map " + path + "!");
+
+            m_header = (const Header *)m_mapping;
+            m_table = (const TensorEntry *)((const char *)m_mapping + m_header->table_offset);
+
+            bool valid = std::memcmp(m_header->magic, cMagic, sizeof(cMagic)) == 0 &&
+                         m_header->version == cVersion &&
+                         m_header->file_size == m_size &&
+                         m_header->table_offset % cAlignment == 0 &&
+                         m_header->table_offset + m_header->num_tensors * sizeof(TensorEntry) <= m_size;
+
+            for (unsigned int i = 0; valid && i < m_header->num_tensors; i++)
+            {
+                valid = m_table[i].data_offset % cAlignment == 0 &&
+                        m_table[i].dimensions <= cMaxDimensions &&
+                        m_table[i].data_offset + m_table[i].num_elements * sizeof(double) <= m_size;
+
+                // get_shape hands out the shape, it has to describe the blob
+                std::uint64_t num_elements = 1U;
+                for (unsigned int j = 0; valid && j < m_table[i].dimensions; j++)
+                    num_elements *= m_table[i].shape[j];
+
+                valid = valid && m_table[i].num_elements == num_elements;
+            }
+
+            if (!valid)
+            {
+                munmap(m_mapping, m_size);
+                throw std::runtime_error(path + " is not a valid checkpoint!");
+            }
+        }
+        MappedCheckpoint::~MappedCheckpoint()
+        {
+            munmap(m_mapping, m_size);
+        }
+
+        unsigned int MappedCheckpoint::get_num_tensors() const
+        {
+            return m_header->num_tensors;
+        }
+        std::string MappedCheckpoint::get_name(const unsigned int &tensor_index) const
+        {
+            const TensorEntry &entry = get_entry(tensor_index);
+
+            return std::string(entry.name, strnlen(entry.name, sizeof(entry.name)));
+        }
+        std::vector<unsigned int> MappedCheckpoint::get_shape(const unsigned int &tensor_index) const
+        {
+            const TensorEntry &entry = get_entry(tensor_index);
+
+            return std::vector<unsigned int>(entry.shape, entry.shape + entry.dimensions);
+        }
+        const double *MappedCheckpoint::get_data(const unsigned int &tensor_index) const
+        {
+            const TensorEntry &entry = get_entry(tensor_index);
+
+            return (const double *)((const char *)m_mapping + entry.data_offset);
+        }
+
+        const TensorEntry &MappedCheckpoint::get_entry(const unsigned int &tensor_index) const
+        {
+            if (tensor_index >= m_header->num_tensors)
+                throw std::invalid_argument("tensor_index out of bounds");
+
+            return m_table[tensor_index];
+        }
+
+        void Load(const MappedCheckpoint &checkpoint, const std::vector<LayerBase *> &model_layers, const std::string &name_prefix)
+        {
+            std::vector<Tensor *> parameters = CollectParameters(model_layers);
+
+            for (unsigned int i = 0; i < parameters.size(); i++)
+            {
+                std::string name = name_prefix + std::to_string(i);
+
+                unsigned int tensor_index = 0;
+                while (tensor_index < checkpoint.get_num_tensors() && checkpoint.get_name(tensor_index) != name)
+                    tensor_index++;
+
+                if (tensor_index == checkpoint.get_num_tensors() || parameters[i]->get_shape() != checkpoint.get_shape(tensor_index))
+                    throw std::invalid_argument("checkpoint doesn't match model!");
+
+                // the values are read straight from the mapped blob
+                parameters[i]->SetElementValues(checkpoint.get_data(tensor_index));
+            }
+        }
+        void Load(const std::string &path, const std::vector<LayerBase *> &model_layers, const std::string &name_prefix)
+        {
+            MappedCheckpoint checkpoint(path);
+
+            Load(checkpoint, model_layers, name_prefix);
+        }
+
+        AsyncWriter::AsyncWriter(const std::string &path_prefix, const unsigned int &num_kept_checkpoints, const unsigned int &interval_games, const double &interval_seconds) : m_path_prefix(path_prefix),
+                                                                                                                                                                             m_num_kept_checkpoints(num_kept_checkpoints),
+                                                                                                                                                                             m_interval_games(interval_games),
+                                                                                                                                                                             m_interval_seconds(interval_seconds),
+                                                                                                                                                                             m_tracked_parameters(),
+                                                                                                                                                                             m_games_since_checkpoint(0U),
+                                                                                                                                                                             m_last_checkpoint_time(std::chrono::steady_clock::now()),
+                                                                                                                                                                             m_next_checkpoint_id(0U),
+                                                                                                                                                                             m_staging_records(),
+                                                                                                                                                                             m_staging_path(),
+                                                                                                                                                                             m_staging_full(false),
+                                                                                                                                                                             m_writing(false),
+                                                                                                                                                                             m_stop(false),
+                                                                                                                                                                             m_written_paths()
+        {
+            // keeping none would delete every checkpoint right after writing it
+            if (num_kept_checkpoints == 0)
+                throw std::invalid_argument("at least one checkpoint needs to be kept!");
+
+            // a restarted run continues the numbering and keeps pruning the checkpoints of the previous runs
+            std::filesystem::path prefix(path_prefix);
+            std::filesystem::path directory = prefix.has_parent_path() ? prefix.parent_path() : std::filesystem::path(".");
+            std::string file_prefix = prefix.filename().string() + ".";
+            std::string file_suffix = ".ckpt";
+
+            std::vector<unsigned int> existing_ids;
+            std::error_code error;
+            for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, error))
+            {
+                std::string file_name = entry.path().filename().string();
+                if (file_name.size() <= file_prefix.size() + file_suffix.size() ||
+                    file_name.compare(0, file_prefix.size(), file_prefix) != 0 ||
+                    file_name.compare(file_name.size() - file_suffix.size(), file_suffix.size(), file_suffix) != 0)
+                    continue;
+
+                std::string id = file_name.substr(file_prefix.size(), file_name.size() - file_prefix.size() - file_suffix.size());
+                if (id.find_first_not_of("0123456789") != std::string::npos || id.size() > 9)
+                    continue;
+
+                existing_ids.push_back(std::stoul(id));
+            }
+
+            std::sort(existing_ids.begin(), existing_ids.end());
+            for (const unsigned int &id : existing_ids)
+                m_written_paths.push_back(path_prefix + "." + std::to_string(id) + ".ckpt");
+
+            if (!existing_ids.empty())
+                m_next_checkpoint_id = existing_ids.back() + 1;
+
+            m_thread = std::thread(&AsyncWriter::Run, this);
+        }
+        AsyncWriter::~AsyncWriter()
+        {
+            Flush();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+
+            m_thread.join();
+        }
+
+        void AsyncWriter::Track(const std::string &name_prefix, const std::vector<Tensor *> &parameters)
+        {
+            m_tracked_parameters.push_back({name_prefix, parameters});
+        }
+
+        bool AsyncWriter::GameFinished()
+        {
+            m_games_since_checkpoint++;
+
+            bool games_due = m_interval_games > 0 && m_games_since_checkpoint >= m_interval_games;
+            bool time_due = m_interval_seconds.count() > 0. && std::chrono::steady_clock::now() - m_last_checkpoint_time >= m_interval_seconds;
+
+            if (!games_due && !time_due)
+                return false;
+
+            Save();
+            return true;
+        }
+        void AsyncWriter::Save()
+        {
+            // copying the values is the only work done on the training thread
+            std::vector<TensorRecord> records;
+            for (const auto &[name_prefix, parameters] : m_tracked_parameters)
+            {
+                std::vector<TensorRecord> parameter_records = Snapshot(parameters, name_prefix);
+                records.insert(records.end(), std::make_move_iterator(parameter_records.begin()), std::make_move_iterator(parameter_records.end()));
+            }
+
+            std::string path = m_path_prefix + "." + std::to_string(m_next_checkpoint_id) + ".ckpt";
+            m_next_checkpoint_id++;
+
+            m_games_since_checkpoint = 0U;
+            m_last_checkpoint_time = std::chrono::steady_clock::now();
+
+            {
+                // a staged checkpoint which hasn't been picked up yet gets replaced by the newer one
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                m_staging_records = std::move(records);
+                m_staging_path = path;
+                m_staging_full = true;
+            }
+            m_condition.notify_all();
+        }
+        void AsyncWriter::Flush()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_condition.wait(lock, [this]() { return !m_staging_full && !m_writing; });
+        }
+
+        void AsyncWriter::Run()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            while (true)
+            {
+                m_condition.wait(lock, [this]() { return m_staging_full || m_stop; });
+
+                if (!m_staging_full)
+                    return;
+
+                std::vector<TensorRecord> records = std::move(m_staging_records);
+                std::string path = m_staging_path;
+                m_staging_full = false;
+                m_writing = true;
+
+                lock.unlock();
+
+                // readers never see a partially written checkpoint
+                std::string temporary_path = path + ".tmp";
+
+                try
+                {
+                    Write(temporary_path, records, true);
+
+                    if (std::rename(temporary_path.c_str(), path.c_str()) != 0)
+                        throw std::runtime_error("failed to rename " + temporary_path + "!");
+
+                    // the rename itself only survives a crash once the directory is synced
+                    SyncDirectory(path);
+
+                    m_written_paths.push_back(path);
+                    while (m_written_paths.size() > m_num_kept_checkpoints)
+                    {
+                        std::remove(m_written_paths.front().c_str());
+                        m_written_paths.pop_front();
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    // a failed checkpoint must not stop the training
+                    std::remove(temporary_path.c_str());
+                    std::cerr << "[-] checkpoint " << path << " failed: " << e.what() << std::endl;
+                }
+
+                lock.lock();
+                m_writing = false;
+                m_condition.notify_all();
+            }
+        }
+    } // namespace checkpoint
+} // namespace ml_lib
\ No newline at end of file
@@ -15,10 +15,45 @@ namespace ml_lib
             unsigned int batchsize = input.get_shape()[1];
             return m_weight_matrix.MatrixMult(input) + m_bias_vector.Repeat(1, batchsize);
         }
+        Tensor Linear::FeedForward(const SparseTensor &input) const
+        {
+            // sums the weight columns selected by the active input elements instead of multiplying the full matrix
+            unsigned int batchsize = input.get_batchsize();
+            return m_weight_matrix.MatrixMult(input) + m_bias_vector.Repeat(1, batchsize);
+        }
         void Linear::LinkLearnableParameter(OptimizerBase *optimizer) {
             optimizer->Link(&m_weight_matrix);
             optimizer->Link(&m_bias_vector);
         }
+
+
+        unsigned int Linear::get_input_dimensions() const
+        {
+            return m_weight_matrix.get_shape()[1];
+        }
+        unsigned int Linear::get_output_dimensions() const
+        {
+            return m_weight_matrix.get_shape()[0];
+        }
+        double Linear::get_weight(const unsigned int &output_index, const unsigned int &input_index) const
+        {
+            return m_weight_matrix.get_element_value_at(output_index + input_index * get_output_dimensions());
+        }
+        double Linear::get_bias(const unsigned int &output_index) const
+        {
+            return m_bias_vector.get_element_value_at(output_index);
+        }
+
+
+        std::unique_ptr<LayerBase> Linear::Detach() const
+        {
+            return std::unique_ptr<LayerBase>(new Linear(m_weight_matrix.Detach(), m_bias_vector.Detach()));
+        }
+
+        Linear::Linear(const Tensor &weight_matrix, const Tensor &bias_vector) : m_weight_matrix(weight_matrix),
+                                                                                  m_bias_vector(bias_vector)
+        {
+        }
         
 
         Softmax::Softmax(unsigned int axis) : m_axis(axis) {}
@@ -39,10 +74,18 @@ namespace ml_lib
 
             return exp_input.HadamardMult(exp_sum.ElementwisePow(Tensor::Scalar(-1.)));
         }
+        std::unique_ptr<LayerBase> Softmax::Detach() const
+        {
+            return std::unique_ptr<LayerBase>(new Softmax(m_axis));
+        }
     
         Tensor Sigmoid::FeedForward(const Tensor& input) const {
             Tensor ones_tensor = Tensor::Ones(input.get_shape());
             return (ones_tensor + Tensor::ElementwiseExp(input.ScalarMult(Tensor::Scalar(-1.)))).ElementwisePow(Tensor::Scalar(-1.));
         }
+        std::unique_ptr<LayerBase> Sigmoid::Detach() const
+        {
+            return std::unique_ptr<LayerBase>(new Sigmoid());
+        }
     } // namespace layer_types
 } // namespace ml_model
\ No newline at end of file
@@ -35,5 +35,9 @@ namespace ml_lib
         {
             m_learnable_parameters.push_back(learnable_parameter);
         }
+        std::vector<Tensor *> MiniBatchSgd::get_learnable_parameters() const
+        {
+            return m_learnable_parameters;
+        }
     } // namespace optimizer
 } // namespace ml_lib
\ No newline at end of file
@@ -0,0 +1,385 @@
+#include "ml_lib/shared_memory.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ml_lib
+{
+    namespace shared_memory
+    {
+        namespace
+        {
+            const std::uint64_t cRingMagic = 0x474e49524d485355; // "USHMRING"
+            const std::uint64_t cSeqlockMagic = 0x4b434f4c51455355; // "USEQLOCK"
+
+            // std::atomic has to work across processes
+            static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory needs lock-free 64 bit atomics");
+
+            std::size_t AlignToCacheLine(const std::size_t &size)
+            {
+                return (size + cCacheLineSize - 1) / cCacheLineSize * cCacheLineSize;
+            }
+        } // namespace
+
+        Region Region::Create(const std::string &name, const std::size_t &size)
+        {
+            // a stale object of a crashed run is replaced
+            shm_unlink(name.c_str());
+
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0)
+                throw std::runtime_error("failed to create shared memory " + name + "!");
+
+            if (ftruncate(fd, size) != 0)
+            {
+                close(fd);
+                shm_unlink(name.c_str());
+                throw std::runtime_error("failed to resize shared memory " + name + "!");
+            }
+
+            void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (data == MAP_FAILED)
+            {
+                shm_unlink(name.c_str());
+                throw std::runtime_error("failed to map shared memory " + name + "!");
+            }
+
+            return Region(name, data, size, true);
+        }
+        Region Region::Open(const std::string &name)
+        {
+            int fd = shm_open(name.c_str(), O_RDWR, 0600);
+            if (fd < 0)
+                throw std::runtime_error("failed to open shared memory " + name + "!");
+
+            struct stat status;
+            if (fstat(fd, &status) != 0)
+            {
+                close(fd);
+                throw std::runtime_error("failed to open shared memory " + name + "!");
+            }
+
+            std::size_t size = status.st_size;
+            void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (data == MAP_FAILED)
+                throw std::runtime_error("failed to map shared memory " + name + "!");
+
+            return Region(name, data, size, false);
+        }
+
+        Region::Region(Region &&obj) noexcept : m_name(std::move(obj.m_name)),
+                                                m_data(obj.m_data),
+                                                m_size(obj.m_size),
+                                                m_owner(obj.m_owner)
+        {
+            obj.m_data = nullptr;
+            obj.m_owner = false;
+        }
+        Region::~Region()
+        {
+            if (m_data == nullptr)
+                return;
+
+            munmap(m_data, m_size);
+
+            if (m_owner)
+                shm_unlink(m_name.c_str());
+        }
+
+        void *Region::get_data() const
+        {
+            return m_data;
+        }
+        std::size_t Region::get_size() const
+        {
+            return m_size;
+        }
+        std::string Region::get_name() const
+        {
+            return m_name;
+        }
+
+        Region::Region(const std::string &name, void *data, const std::size_t &size, const bool &owner) : m_name(name),
+                                                                                                          m_data(data),
+                                                                                                          m_size(size),
+                                                                                                          m_owner(owner)
+        {
+        }
+
+        // every counter lives on its own cache line
+        struct Ring::Header
+        {
+            alignas(cCacheLineSize) std::uint64_t magic;
+            std::uint64_t capacity;
+            std::uint64_t slot_size;
+            std::uint64_t slot_stride;
+
+            alignas(cCacheLineSize) std::atomic<std::uint64_t> enqueue_position;
+            alignas(cCacheLineSize) std::atomic<std::uint64_t> dequeue_position;
+            alignas(cCacheLineSize) std::atomic<std::uint64_t> num_drops;
+        };
+        struct Ring::SlotHeader
+        {
+            std::atomic<std::uint64_t> sequence;
+            std::uint64_t size;
+        };
+
+        std::size_t Ring::RequiredSize(const std::size_t &capacity, const std::size_t &slot_size)
+        {
+            return AlignToCacheLine(sizeof(Header)) + capacity * AlignToCacheLine(sizeof(SlotHeader) + slot_size);
+        }
+
+        Ring Ring::Initialize(void *memory, const std::size_t &capacity, const std::size_t &slot_size)
+        {
+            if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+                throw std::invalid_argument("capacity needs to be a power of two!");
+            if ((std::uintptr_t)memory % cCacheLineSize != 0)
+                throw std::invalid_argument("memory needs to be cache line aligned!");
+
+            Header *header = new (memory) Header();
+            header->capacity = capacity;
+            header->slot_size = slot_size;
+            header->slot_stride = AlignToCacheLine(sizeof(SlotHeader) + slot_size);
+            header->enqueue_position.store(0, std::memory_order_relaxed);
+            header->dequeue_position.store(0, std::memory_order_relaxed);
+            header->num_drops.store(0, std::memory_order_relaxed);
+
+            Ring ring(header);
+            for (std::uint64_t i = 0; i < capacity; i++)
+            {
+                SlotHeader *slot = new (ring.get_slot(i)) SlotHeader();
+                slot->sequence.store(i, std::memory_order_relaxed);
+                slot->size = 0;
+            }
+
+            // the magic number is written last, attaching processes only see initialized rings
+            std::atomic_thread_fence(std::memory_order_release);
+            header->magic = cRingMagic;
+
+            return ring;
+        }
+        Ring Ring::Attach(void *memory)
+        {
+            Header *header = (Header *)memory;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (header->magic != cRingMagic)
+                throw std::runtime_error("memory does not hold a ring!");
+
+            return Ring(header);
+        }
+
+        bool Ring::TryPush(const void *message, const std::size_t &size)
+        {
+            if (Enqueue(message, size))
+                return true;
+
+            m_header->num_drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        void Ring::Push(const void *message, const std::size_t &size)
+        {
+            // spin shortly, then give the cpu away
+            for (unsigned int attempt = 0; !Enqueue(message, size); attempt++)
+            {
+                if (attempt < 64)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        bool Ring::Enqueue(const void *message, const std::size_t &size)
+        {
+            if (size > m_header->slot_size)
+                throw std::invalid_argument("message does not fit into a slot!");
+
+            std::uint64_t position = m_header->enqueue_position.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                SlotHeader *slot = get_slot(position);
+                std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+                std::int64_t difference = (std::int64_t)(sequence - position);
+
+                if (difference == 0)
+                {
+                    if (m_header->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        std::memcpy((unsigned char *)slot + sizeof(SlotHeader), message, size);
+                        slot->size = size;
+                        slot->sequence.store(position + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_header->enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        bool Ring::TryPop(std::vector<unsigned char> &message)
+        {
+            std::uint64_t position = m_header->dequeue_position.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                SlotHeader *slot = get_slot(position);
+                std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+                std::int64_t difference = (std::int64_t)(sequence - (position + 1));
+
+                if (difference == 0)
+                {
+                    if (m_header->dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        const unsigned char *data = (const unsigned char *)slot + sizeof(SlotHeader);
+                        message.assign(data, data + slot->size);
+
+                        slot->sequence.store(position + m_header->capacity, std::memory_order_release);
+
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_header->dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::size_t Ring::get_depth() const
+        {
+            std::uint64_t enqueue_position = m_header->enqueue_position.load(std::memory_order_relaxed);
+            std::uint64_t dequeue_position = m_header->dequeue_position.load(std::memory_order_relaxed);
+
+            return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+        }
+        std::size_t Ring::get_num_drops() const
+        {
+            return m_header->num_drops.load(std::memory_order_relaxed);
+        }
+        std::size_t Ring::get_slot_size() const
+        {
+            return m_header->slot_size;
+        }
+
+        Ring::Ring(Header *header) : m_header(header)
+        {
+        }
+
+        Ring::SlotHeader *Ring::get_slot(const std::uint64_t &position) const
+        {
+            unsigned char *slots = (unsigned char *)m_header + AlignToCacheLine(sizeof(Header));
+
+            return (SlotHeader *)(slots + (position & (m_header->capacity - 1)) * m_header->slot_stride);
+        }
+
+        struct Seqlock::Header
+        {
+            alignas(cCacheLineSize) std::uint64_t magic;
+            std::uint64_t num_values;
+
+            // odd while the writer is copying
+            alignas(cCacheLineSize) std::atomic<std::uint64_t> sequence;
+        };
+
+        std::size_t Seqlock::RequiredSize(const std::size_t &num_values)
+        {
+            return AlignToCacheLine(sizeof(Header)) + num_values * sizeof(double);
+        }
+
+        Seqlock Seqlock::Initialize(void *memory, const std::size_t &num_values)
+        {
+            if ((std::uintptr_t)memory % cCacheLineSize != 0)
+                throw std::invalid_argument("memory needs to be cache line aligned!");
+
+            Header *header = new (memory) Header();
+            header->num_values = num_values;
+            header->sequence.store(0, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_release);
+            header->magic = cSeqlockMagic;
+
+            return Seqlock(header);
+        }
+        Seqlock Seqlock::Attach(void *memory)
+        {
+            Header *header = (Header *)memory;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (header->magic != cSeqlockMagic)
+                throw std::runtime_error("memory does not hold a seqlock!");
+
+            return Seqlock(header);
+        }
+
+        void Seqlock::Write(const double *values)
+        {
+            double *shared_values = get_values();
+            std::uint64_t sequence = m_header->sequence.load(std::memory_order_relaxed);
+
+            m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // element wise atomic stores, readers may copy concurrently
+            for (std::uint64_t i = 0; i < m_header->num_values; i++)
+                std::atomic_ref<double>(shared_values[i]).store(values[i], std::memory_order_relaxed);
+
+            m_header->sequence.store(sequence + 2, std::memory_order_release);
+        }
+        bool Seqlock::TryRead(double *values, std::uint64_t &version) const
+        {
+            double *shared_values = get_values();
+
+            std::uint64_t sequence_before = m_header->sequence.load(std::memory_order_acquire);
+            if (sequence_before % 2 == 1)
+                return false;
+
+            for (std::uint64_t i = 0; i < m_header->num_values; i++)
+                values[i] = std::atomic_ref<double>(shared_values[i]).load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::uint64_t sequence_after = m_header->sequence.load(std::memory_order_relaxed);
+
+            version = sequence_before / 2;
+            return sequence_before == sequence_after;
+        }
+        std::uint64_t Seqlock::get_version() const
+        {
+            return m_header->sequence.load(std::memory_order_acquire) / 2;
+        }
+        std::size_t Seqlock::get_num_values() const
+        {
+            return m_header->num_values;
+        }
+
+        Seqlock::Seqlock(Header *header) : m_header(header)
+        {
+        }
+
+        double *Seqlock::get_values() const
+        {
+            return (double *)((unsigned char *)m_header + AlignToCacheLine(sizeof(Header)));
+        }
+    } // namespace shared_memory
+} // namespace ml_lib
\ No newline at end of file
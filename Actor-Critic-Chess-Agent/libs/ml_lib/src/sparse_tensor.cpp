@@ -0,0 +1,203 @@
+#include "ml_lib/sparse_tensor.h"
+
+namespace ml_lib
+{
+    SparseTensor SparseTensor::Empty()
+    {
+        return SparseTensor(0U, {});
+    }
+
+    SparseTensor::SparseTensor(const unsigned int &num_rows, const std::vector<std::vector<unsigned int>> &active_indices) : m_num_rows(num_rows),
+                                                                                                                           m_binary_indices(active_indices),
+                                                                                                                           m_valued_indices(active_indices.size()),
+                                                                                                                           m_values(Tensor::Zeros({0U}))
+    {
+        for (const std::vector<unsigned int> &batch_element_indices : m_binary_indices)
+        {
+            for (const unsigned int &index : batch_element_indices)
+            {
+                if (index >= m_num_rows)
+                    throw std::invalid_argument("index out of bounds!");
+            }
+        }
+    }
+
+    SparseTensor SparseTensor::FromDense(const Tensor &dense)
+    {
+        // the last dimension of dense is the batch dimension
+        std::vector<unsigned int> dense_shape = dense.get_shape();
+        unsigned int batchsize = dense_shape.back();
+        unsigned int num_rows = dense.get_num_elements() / batchsize;
+
+        std::vector<std::vector<unsigned int>> active_indices(batchsize);
+
+        for (unsigned int y = 0; y < batchsize; y++)
+        {
+            for (unsigned int x = 0; x < num_rows; x++)
+            {
+                if (dense.get_element_value_at(x + y * num_rows) != 0.)
+                    active_indices[y].push_back(x);
+            }
+        }
+
+        return SparseTensor(num_rows, active_indices);
+    }
+    SparseTensor SparseTensor::Gather(const Tensor &dense, const SparseTensor &support)
+    {
+        // keeps the elements of dense (including their gradients) at the active positions of support
+        if (dense.get_num_elements() != support.m_num_rows * support.get_batchsize())
+            throw;
+
+        unsigned int batchsize = support.get_batchsize();
+
+        std::vector<std::vector<unsigned int>> valued_indices(batchsize);
+        std::vector<unsigned int> dense_indices;
+
+        for (unsigned int y = 0; y < batchsize; y++)
+        {
+            valued_indices[y] = support.m_binary_indices[y];
+            valued_indices[y].insert(valued_indices[y].end(), support.m_valued_indices[y].begin(), support.m_valued_indices[y].end());
+
+            for (const unsigned int &x : valued_indices[y])
+                dense_indices.push_back(x + y * support.m_num_rows);
+        }
+
+        return SparseTensor(support.m_num_rows,
+                            std::vector<std::vector<unsigned int>>(batchsize),
+                            valued_indices,
+                            dense.Gather(dense_indices));
+    }
+    SparseTensor SparseTensor::Concatenate(const SparseTensor &a, const SparseTensor &b, unsigned int axis)
+    {
+        // axis 0: stack the rows of b below the rows of a
+        // axis 1: append the batch elements of b to the batch elements of a
+        if (axis == 1)
+        {
+            if (a.m_num_rows != b.m_num_rows)
+                throw;
+
+            std::vector<std::vector<unsigned int>> binary_indices = a.m_binary_indices;
+            std::vector<std::vector<unsigned int>> valued_indices = a.m_valued_indices;
+
+            binary_indices.insert(binary_indices.end(), b.m_binary_indices.begin(), b.m_binary_indices.end());
+            valued_indices.insert(valued_indices.end(), b.m_valued_indices.begin(), b.m_valued_indices.end());
+
+            return SparseTensor(a.m_num_rows,
+                                binary_indices,
+                                valued_indices,
+                                Tensor::Concatenate(a.m_values, b.m_values, 0));
+        }
+
+        if (axis != 0 || a.get_batchsize() != b.get_batchsize())
+            throw;
+
+        unsigned int batchsize = a.get_batchsize();
+
+        std::vector<std::vector<unsigned int>> binary_indices(batchsize);
+        std::vector<std::vector<unsigned int>> valued_indices(batchsize);
+
+        // values of a and b are interleaved per batch element
+        unsigned int a_num_values = a.m_values.get_num_elements();
+        unsigned int a_value_index = 0;
+        unsigned int b_value_index = 0;
+        std::vector<unsigned int> value_order;
+
+        for (unsigned int y = 0; y < batchsize; y++)
+        {
+            binary_indices[y] = a.m_binary_indices[y];
+            for (const unsigned int &x : b.m_binary_indices[y])
+                binary_indices[y].push_back(x + a.m_num_rows);
+
+            valued_indices[y] = a.m_valued_indices[y];
+            for (const unsigned int &x : b.m_valued_indices[y])
+                valued_indices[y].push_back(x + a.m_num_rows);
+
+            for (unsigned int i = 0; i < a.m_valued_indices[y].size(); i++)
+                value_order.push_back(a_value_index++);
+            for (unsigned int i = 0; i < b.m_valued_indices[y].size(); i++)
+                value_order.push_back(a_num_values + b_value_index++);
+        }
+
+        Tensor values = Tensor::Concatenate(a.m_values, b.m_values, 0).Gather(value_order);
+
+        return SparseTensor(a.m_num_rows + b.m_num_rows,
+                            binary_indices,
+                            valued_indices,
+                            values);
+    }
+
+    SparseTensor SparseTensor::Remap(const std::function<unsigned int(const unsigned int &)> &index_func) const
+    {
+        SparseTensor remapped(*this);
+
+        for (std::vector<unsigned int> &batch_element_indices : remapped.m_binary_indices)
+        {
+            for (unsigned int &index : batch_element_indices)
+                index = index_func(index);
+        }
+        for (std::vector<unsigned int> &batch_element_indices : remapped.m_valued_indices)
+        {
+            for (unsigned int &index : batch_element_indices)
+                index = index_func(index);
+        }
+
+        return remapped;
+    }
+    Tensor SparseTensor::ToDense() const
+    {
+        unsigned int batchsize = get_batchsize();
+
+        std::vector<unsigned int> binary_positions;
+        std::vector<unsigned int> valued_positions;
+
+        for (unsigned int y = 0; y < batchsize; y++)
+        {
+            for (const unsigned int &x : m_binary_indices[y])
+                binary_positions.push_back(x + y * m_num_rows);
+            for (const unsigned int &x : m_valued_indices[y])
+                valued_positions.push_back(x + y * m_num_rows);
+        }
+
+        Tensor dense = Tensor::Scatter(m_values, valued_positions, {m_num_rows, batchsize});
+
+        for (const unsigned int &position : binary_positions)
+            dense.SetSingleElementValue(1., position);
+
+        return dense;
+    }
+
+    unsigned int SparseTensor::get_num_rows() const
+    {
+        return m_num_rows;
+    }
+    unsigned int SparseTensor::get_batchsize() const
+    {
+        return m_binary_indices.size();
+    }
+    unsigned int SparseTensor::get_num_active_elements() const
+    {
+        unsigned int num_active_elements = 0;
+
+        for (unsigned int y = 0; y < get_batchsize(); y++)
+            num_active_elements += m_binary_indices[y].size() + m_valued_indices[y].size();
+
+        return num_active_elements;
+    }
+    std::vector<unsigned int> SparseTensor::get_active_indices(const unsigned int &batch_index) const
+    {
+        std::vector<unsigned int> active_indices = m_binary_indices[batch_index];
+        active_indices.insert(active_indices.end(), m_valued_indices[batch_index].begin(), m_valued_indices[batch_index].end());
+
+        return active_indices;
+    }
+
+    SparseTensor::SparseTensor(const unsigned int &num_rows,
+                               const std::vector<std::vector<unsigned int>> &binary_indices,
+                               const std::vector<std::vector<unsigned int>> &valued_indices,
+                               const Tensor &values) : m_num_rows(num_rows),
+                                                       m_binary_indices(binary_indices),
+                                                       m_valued_indices(valued_indices),
+                                                       m_values(values)
+    {
+    }
+} // namespace ml_lib
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ml_lib/tensor.h"
+#include "ml_lib/sparse_tensor.h"
 
 namespace ml_lib
 {
@@ -102,6 +103,13 @@ namespace ml_lib
 	{
 		return m_elements_ptr[index].get_value();
 	}
+	void Tensor::CopyElementValues(double *destination) const
+	{
+		for (unsigned int i = 0; i < m_num_elements; i++)
+		{
+			destination[i] = m_elements_ptr[i].get_value();
+		}
+	}
 	unsigned int Tensor::get_dimensions() const
 	{
 		return m_shape.size();
@@ -139,6 +147,18 @@ namespace ml_lib
 		m_elements_ptr[0].Backward();
 	}
 
+	Tensor Tensor::Detach() const
+	{
+		// same values without any autodiff dependency
+		// detached tensors can be read by several threads at once
+		Tensor detached_tensor = Tensor(m_shape);
+
+		for (unsigned int i = 0; i < m_num_elements; i++)
+			detached_tensor.m_elements_ptr[i] = Element(m_elements_ptr[i].get_value());
+
+		return detached_tensor;
+	}
+
 	Tensor &Tensor::operator=(const Tensor &other)
 	{
 		if (&other != this)
@@ -324,6 +344,49 @@ namespace ml_lib
 		return product;
 	}
 
+	Tensor Tensor::MatrixMult(const SparseTensor &other) const
+	{
+		// only the columns selected by the active elements of other contribute to the product
+		// thus the backward pass only reaches these columns as well
+		const unsigned int &multiplier_rows = m_shape[0];
+		const unsigned int &multiplier_columns = m_shape[1];
+		const unsigned int batchsize = other.get_batchsize();
+
+		if(multiplier_columns != other.m_num_rows)
+			throw;
+
+		Tensor product({multiplier_rows, batchsize});
+
+		unsigned int value_index = 0;
+		for (unsigned int y = 0; y < batchsize; y++)
+		{
+			Element *product_column = product.m_elements_ptr + y * multiplier_rows;
+
+			// binary elements: sum the selected columns
+			for (const unsigned int &j : other.m_binary_indices[y])
+			{
+				const Element *multiplier_column = m_elements_ptr + j * multiplier_rows;
+
+				for (unsigned int x = 0; x < multiplier_rows; x++)
+					product_column[x] = product_column[x] + multiplier_column[x];
+			}
+
+			// valued elements: scale the selected columns
+			for (const unsigned int &j : other.m_valued_indices[y])
+			{
+				const Element *multiplier_column = m_elements_ptr + j * multiplier_rows;
+				const Element &value = other.m_values.m_elements_ptr[value_index];
+
+				for (unsigned int x = 0; x < multiplier_rows; x++)
+					product_column[x] = product_column[x] + multiplier_column[x] * value;
+
+				value_index++;
+			}
+		}
+
+		return product;
+	}
+
 	Tensor Tensor::Sum(const unsigned int &axis) const
 	{
 		if(axis >= m_shape.size() || axis < 0)
@@ -432,6 +495,38 @@ namespace ml_lib
 		return concat;
 	}
 
+	Tensor Tensor::Gather(const std::vector<unsigned int> &indices) const
+	{
+		Tensor gathered({(unsigned int)indices.size()});
+
+		for (unsigned int i = 0; i < indices.size(); i++)
+		{
+			if (indices[i] >= m_num_elements)
+				throw std::invalid_argument("index out of bounds!");
+
+			gathered.m_elements_ptr[i] = m_elements_ptr[indices[i]];
+		}
+
+		return gathered;
+	}
+	Tensor Tensor::Scatter(const Tensor &values, const std::vector<unsigned int> &indices, const std::vector<unsigned int> &shape)
+	{
+		if (values.m_num_elements != indices.size())
+			throw;
+
+		Tensor scattered = Tensor::Zeros(shape);
+
+		for (unsigned int i = 0; i < indices.size(); i++)
+		{
+			if (indices[i] >= scattered.m_num_elements)
+				throw std::invalid_argument("index out of bounds!");
+
+			scattered.m_elements_ptr[indices[i]] = values.m_elements_ptr[i];
+		}
+
+		return scattered;
+	}
+
 	unsigned int Tensor::ArgFind(const std::function<bool(const double &)> &find_func) const
 	{
 		unsigned int index;
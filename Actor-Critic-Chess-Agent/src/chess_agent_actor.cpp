@@ -0,0 +1,63 @@
+#include "actor-critic-chess-agent/environment.h"
+
+namespace chess_agent
+{
+    ml_lib::Tensor ActorFeedForward(const ml_lib::Tensor& board_state, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model) 
+    {
+        // board_state shape = {8, 8, 16, 2}
+        auto out = board_state;
+        
+        unsigned int batchsize = out.get_num_elements() / 2048;
+        out = out.Reshape({2048, batchsize});
+
+        for(unsigned int i = 0; i < actor_model.size() -1; i++) {
+            out = actor_model[i]->FeedForward(out);
+        }
+
+        out = out.HadamardMult(action_space);
+
+        //out = actor_model.back()->FeedForward(out);
+
+        out = out.Reshape({8, 8, 16, batchsize});
+
+        return out;
+    }
+    ml_lib::Tensor ActorFeedForward(const ml_lib::SparseTensor& board_state, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model) 
+    {
+        // board_state shape = {2048, batchsize}
+        // the first layer only sums the weight columns of the pieces on the board
+        unsigned int batchsize = board_state.get_batchsize();
+        auto out = actor_model[0]->FeedForward(board_state);
+
+        for(unsigned int i = 1; i < actor_model.size() -1; i++) {
+            out = actor_model[i]->FeedForward(out);
+        }
+
+        out = out.HadamardMult(action_space);
+
+        out = out.Reshape({8, 8, 16, batchsize});
+
+        return out;
+    }
+    ml_lib::Tensor ActorFeedForward(const ml_lib::Accumulator& board_state_accumulator, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model) 
+    {
+        // the accumulator already holds the pre-activations of the first layer
+        return chess_agent::ActorFeedForwardFromFirstLayer(board_state_accumulator.get_pre_activations(), action_space, actor_model);
+    }
+    ml_lib::Tensor ActorFeedForwardFromFirstLayer(const ml_lib::Tensor& first_layer_out, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> actor_model) 
+    {
+        // first_layer_out shape = {1024, batchsize}
+        unsigned int batchsize = first_layer_out.get_shape()[1];
+        auto out = first_layer_out;
+
+        for(unsigned int i = 1; i < actor_model.size() -1; i++) {
+            out = actor_model[i]->FeedForward(out);
+        }
+
+        out = out.HadamardMult(action_space);
+
+        out = out.Reshape({8, 8, 16, batchsize});
+
+        return out;
+    }
+} // namespace chess_agent
\ No newline at end of file
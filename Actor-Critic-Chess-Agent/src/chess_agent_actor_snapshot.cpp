@@ -0,0 +1,32 @@
+#include "actor-critic-chess-agent/environment.h"
+
+namespace chess_agent
+{
+    std::shared_ptr<const ActorSnapshot> ActorSnapshot::Make(const std::vector<ml_lib::LayerBase*> &actor_model)
+    {
+        std::shared_ptr<ActorSnapshot> snapshot(new ActorSnapshot());
+
+        for (auto layer : actor_model)
+            snapshot->m_layers.push_back(layer->Detach());
+
+        snapshot->m_first_layer = dynamic_cast<const ml_lib::layer_type::Linear *>(snapshot->m_layers[0].get());
+        if (snapshot->m_first_layer == nullptr)
+            throw std::invalid_argument("first actor layer needs to be linear!");
+
+        return snapshot;
+    }
+
+    std::vector<ml_lib::LayerBase*> ActorSnapshot::get_model() const
+    {
+        std::vector<ml_lib::LayerBase*> model;
+
+        for (const auto &layer : m_layers)
+            model.push_back(layer.get());
+
+        return model;
+    }
+    const ml_lib::layer_type::Linear *ActorSnapshot::get_first_layer() const
+    {
+        return m_first_layer;
+    }
+} // namespace chess_agent
\ No newline at end of file
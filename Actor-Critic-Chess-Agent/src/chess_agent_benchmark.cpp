@@ -0,0 +1,172 @@
+#include "actor-critic-chess-agent/environment.h"
+
+#include <random>
+#include <fstream>
+#include <iomanip>
+
+#include <sys/resource.h>
+
+// same shapes as chess_agent::train
+const int cBenchmarkBatchsize = 1;
+const int cBenchmarkReplayMemorySize = 100;
+
+enum Phase {
+    cEnvStep,
+    cGenerateBoardState,
+    cActorFeedForward,
+    cCriticFeedForward,
+    cStep,
+    cReplayBatch,
+    cNumPhases
+};
+const std::array<const char*, cNumPhases> cPhaseNames = {"env_step",
+                                                         "generate_board_state",
+                                                         "actor_feed_forward",
+                                                         "critic_feed_forward",
+                                                         "step",
+                                                         "replay_batch"};
+
+// runs f and adds its duration to the phase
+template <typename F>
+auto Timed(std::array<double, cNumPhases>& phase_seconds, const Phase& phase, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    struct AddDuration {
+        std::chrono::steady_clock::time_point start;
+        double& seconds;
+        ~AddDuration() { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+    } add_duration{start, phase_seconds[phase]};
+
+    return f();
+}
+
+long PeakRssKilobytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // kilobytes on linux
+    return usage.ru_maxrss;
+}
+
+namespace chess_agent {
+    void benchmark(const unsigned int& num_games, const unsigned int& max_moves_per_game, const unsigned int& seed, std::vector<ml_lib::LayerBase*>& actor_model, const std::string& output_path)
+    {
+        // ml_lib draws initial weights and replay batches from std::rand
+        std::srand(seed);
+        std::mt19937 rng(seed);
+
+        ml_lib::layer_type::Linear critic_l1(3072, 1000, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+        ml_lib::layer_type::Linear critic_l2(1000, 500, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+        ml_lib::layer_type::Linear critic_l3(500, 1, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+        std::vector<ml_lib::LayerBase*> critic_model = {&critic_l1, &critic_l2, &critic_l3};
+        ml_lib::Lossfunction critic_lossfunc = ml_lib::lossfunction::CrossEntropy;
+
+        ml_lib::optimizer::MiniBatchSgd actor_optimizer(actor_model, 0.1);
+        ml_lib::optimizer::MiniBatchSgd critic_optimizer(critic_model, 0.1);
+
+        ml_lib::ReplayMemory<chess_agent::Replay> rm(cBenchmarkReplayMemorySize);
+
+        std::array<double, cNumPhases> phase_seconds = {};
+        unsigned long long num_positions = 0;
+        unsigned long long num_samples = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for(unsigned int game_id = 0; game_id < num_games; game_id++) {
+            chess_agent::Environment env;
+            std::vector<chess_agent::Replay> game_replays;
+            bool game_finished = false;
+
+            // moves are drawn from the seeded rng, thus every run plays the same games regardless of the weights
+            for(unsigned int move_id = 0; move_id < max_moves_per_game && !game_finished; move_id++) {
+                auto cur_state = Timed(phase_seconds, cGenerateBoardState, [&]() { return env.GenerateSparseBoardState(); });
+                auto action_space = Timed(phase_seconds, cGenerateBoardState, [&]() { return env.GenerateActionSpace(); });
+
+                auto action_prop_distr = Timed(phase_seconds, cActorFeedForward, [&]() {
+                    return ActorFeedForward(cur_state, action_space, actor_model);
+                });
+
+                auto legal_moves = env.get_legal_moves();
+                auto action = legal_moves[rng() % legal_moves.size()];
+
+                game_finished = Timed(phase_seconds, cEnvStep, [&]() { return env.MovePiece(action); });
+                num_positions++;
+
+                auto next_state = Timed(phase_seconds, cGenerateBoardState, [&]() { return env.GenerateSparseBoardState(); });
+
+                if(env.get_active_player() != env.cDefaultViewPoint) {
+                    cur_state = Environment::SwitchBoardStatePov(cur_state);
+                    next_state = Environment::SwitchBoardStatePov(next_state);
+                }
+
+                game_replays.push_back(Replay(cur_state, next_state, action_prop_distr.Detach(), action_space, ml_lib::Tensor::Scalar(0.)));
+            }
+
+            // the player who is to move when the game ends counts as winner, like in SelfPlay
+            auto cur_player = chess::Piece::Colour::White;
+            for(auto& replay: game_replays) {
+                replay.set_return(ml_lib::Tensor::Scalar(cur_player == env.get_active_player() ? 1. : 0.));
+                rm.Put(replay);
+
+                cur_player = chess::Game::Opponent(cur_player);
+            }
+
+            // one training step per game, like the learner of chess_agent::train
+            auto replay_batch = Timed(phase_seconds, cReplayBatch, [&]() { return rm.GenerateRandomBatch<cBenchmarkBatchsize>(); });
+
+            auto actor_out = Timed(phase_seconds, cActorFeedForward, [&]() {
+                return ActorFeedForward(replay_batch.get_state(), replay_batch.get_action_space(), actor_model);
+            });
+            auto critic_out = Timed(phase_seconds, cCriticFeedForward, [&]() {
+                return CriticFeedForward(replay_batch.get_state(), actor_out, replay_batch.get_action_space(), critic_model);
+            });
+
+            Timed(phase_seconds, cStep, [&]() {
+                auto critic_loss = critic_lossfunc(critic_out, replay_batch.get_return());
+                critic_optimizer.Step(critic_loss);
+
+                auto actor_loss = critic_out.ScalarMult(ml_lib::Tensor::Scalar(-1.));
+                actor_optimizer.Step(actor_loss);
+            });
+            num_samples += cBenchmarkBatchsize;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        long peak_rss_kilobytes = PeakRssKilobytes();
+
+        // everything outside the phases, mostly releasing autodiff graphs
+        double other_seconds = seconds;
+        for(const double& s: phase_seconds)
+            other_seconds -= s;
+
+        std::cout << "[+] benchmark: " << num_games << " games, " << num_positions << " positions, " << num_samples << " samples in " << seconds << " s" << std::endl;
+        std::cout << "    games/s:     " << num_games / seconds << std::endl;
+        std::cout << "    positions/s: " << num_positions / seconds << std::endl;
+        std::cout << "    samples/s:   " << num_samples / seconds << std::endl;
+        std::cout << "    peak rss:    " << peak_rss_kilobytes / 1024. << " MB" << std::endl;
+        for(int phase = 0; phase < cNumPhases; phase++)
+            std::cout << "    " << std::left << std::setw(22) << cPhaseNames[phase] << phase_seconds[phase] << " s (" << 100. * phase_seconds[phase] / seconds << " %)" << std::endl;
+        std::cout << "    " << std::left << std::setw(22) << "other" << other_seconds << " s (" << 100. * other_seconds / seconds << " %)" << std::endl;
+
+        std::ofstream out(output_path);
+        if(!out)
+            throw std::runtime_error("failed to open " + output_path + "!");
+
+        out << "{\n";
+        out << "  \"games\": " << num_games << ",\n";
+        out << "  \"max_moves_per_game\": " << max_moves_per_game << ",\n";
+        out << "  \"seed\": " << seed << ",\n";
+        out << "  \"positions\": " << num_positions << ",\n";
+        out << "  \"samples\": " << num_samples << ",\n";
+        out << "  \"seconds\": " << seconds << ",\n";
+        out << "  \"games_per_second\": " << num_games / seconds << ",\n";
+        out << "  \"positions_per_second\": " << num_positions / seconds << ",\n";
+        out << "  \"samples_per_second\": " << num_samples / seconds << ",\n";
+        out << "  \"peak_rss_kilobytes\": " << peak_rss_kilobytes << ",\n";
+        out << "  \"phase_seconds\": {\n";
+        for(int phase = 0; phase < cNumPhases; phase++)
+            out << "    \"" << cPhaseNames[phase] << "\": " << phase_seconds[phase] << ",\n";
+        out << "    \"other\": " << other_seconds << "\n";
+        out << "  }\n";
+        out << "}\n";
+    }
+} // namespace chess_agent
\ No newline at end of file
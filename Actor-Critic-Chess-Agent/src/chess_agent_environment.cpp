@@ -6,7 +6,9 @@ namespace chess_agent
     const chess::Piece::Colour Environment::cFirstIdPieceColour = chess::Piece::Colour::White;
 
     Environment::Environment() : m_piece_positions(BasicPiecePositions()),
-                                 m_game()
+                                 m_previous_piece_positions(),
+                                 m_game(),
+                                 m_linked_accumulators()
     {
 
     }
@@ -48,6 +50,20 @@ namespace chess_agent
 
         return mirrored_board_state;
     }
+    ml_lib::SparseTensor Environment::SwitchBoardStatePov(const ml_lib::SparseTensor &board_state)
+    {
+        // only the active elements have to be mirrored
+        // index = board_pos + piece_id * 64
+        auto mirror_index = [](const unsigned int &index)
+        {
+            unsigned int board_pos = index % 64;
+            unsigned int piece_offset = index - board_pos;
+
+            return piece_offset + MirrorBoardPosition(board_pos);
+        };
+
+        return board_state.Remap(mirror_index);
+    }
 
     chess::Move Environment::ActionPropDistrToMove(const ml_lib::Tensor &action_prop_distr)
     {
@@ -97,12 +113,12 @@ namespace chess_agent
         // else 16
         int piece_id = 0;
         for(;;piece_id++) {
-            if(m_piece_positions[piece_id] == move.m_from)
+            if(m_piece_positions[piece_id] == move.get_from())
                 break;
         }
         piece_id = (piece_id + 16) % 16;
         
-        int to = move.m_to;
+        int to = move.get_to();
         
         // all action_spaces are normalized to pov of active_player
         // thus if ative_player is not default pov all positions need to be mirrored
@@ -120,7 +136,7 @@ namespace chess_agent
     {
         return m_game.get_board();
     }
-    std::vector<chess::Move> Environment::get_legal_moves() const {
+    std::span<const chess::Move> Environment::get_legal_moves() const {
         return m_game.get_legal_moves();
     }
     chess::Piece::Colour Environment::get_active_player() const
@@ -130,6 +146,8 @@ namespace chess_agent
 
     bool Environment::MovePiece(const chess::Move &move)
     {
+        std::array<int, 32> previous_piece_positions = m_piece_positions;
+
         chess::Piece::Colour active_player = m_game.get_active_player();
         int first_player_piece_id = active_player == cFirstIdPieceColour ? 0 : 16;
         int first_opponent_piece_id = (first_player_piece_id + 16) % 32;
@@ -137,9 +155,9 @@ namespace chess_agent
         // update piece_position for moving piece
         for (unsigned int i = first_player_piece_id; i - first_player_piece_id < 16; i++)
         {
-            if (m_piece_positions[i] == move.m_from)
+            if (m_piece_positions[i] == move.get_from())
             {
-                m_piece_positions[i] = move.m_to;
+                m_piece_positions[i] = move.get_to();
                 break;
             }
         }
@@ -147,39 +165,103 @@ namespace chess_agent
         // check for capture, move captured piece to -1
         for (unsigned int i = first_opponent_piece_id; i - first_opponent_piece_id < 16; i++)
         {
-            if (m_piece_positions[i] == move.m_to)
+            if (m_piece_positions[i] == move.get_to())
             {
                 m_piece_positions[i] = -1;
                 break;
             }
         }
 
+        m_previous_piece_positions.push_back(previous_piece_positions);
+        UpdateLinkedAccumulators(previous_piece_positions);
+
         return m_game.MovePiece(move);
     }
+    void Environment::UndoMove()
+    {
+        if (m_previous_piece_positions.empty())
+            throw std::logic_error("there is no move to undo!");
+
+        m_piece_positions = m_previous_piece_positions.back();
+        m_previous_piece_positions.pop_back();
+
+        m_game.UnmakeMove();
+
+        // an accumulator linked after the move has no undo frame for it
+        for (auto &[accumulator, pov] : m_linked_accumulators)
+        {
+            if (accumulator->get_num_undo_frames() > 0)
+                accumulator->Pop();
+            else
+                accumulator->Refresh(pov == cDefaultViewPoint ? GenerateSparseBoardState() : SwitchBoardStatePov(GenerateSparseBoardState()));
+        }
+    }
     void Environment::Reset()
     {
         m_piece_positions = BasicPiecePositions();
+        m_previous_piece_positions.clear();
 
         m_game.Reset();
+
+        RefreshLinkedAccumulators();
+    }
+
+    void Environment::LinkAccumulator(ml_lib::Accumulator *accumulator, const chess::Piece::Colour &pov)
+    {
+        m_linked_accumulators.push_back({accumulator, pov});
+
+        accumulator->Refresh(pov == cDefaultViewPoint ? GenerateSparseBoardState() : SwitchBoardStatePov(GenerateSparseBoardState()));
     }
 
     ml_lib::Tensor Environment::GenerateBoardState() const
     {
-        ml_lib::Tensor state = ml_lib::Tensor::Zeros({8, 8, 16, 2, 1});
+        std::vector<double> state_values(2048, 0.);
+        FillBoardState(state_values.data());
 
+        return ml_lib::Tensor({8, 8, 16, 2, 1}, state_values.data());
+    }
+    void Environment::FillBoardState(double *board_state) const
+    {
         for (unsigned int i = 0; i < m_piece_positions.size(); i++)
         {
             int piece_position = m_piece_positions[i];
             int piece_index = i;
 
+            // captured pieces are not on the board
+            if (piece_position < 0)
+                continue;
+
             int piece_state_index = piece_position + piece_index * 64;
 
-            state.SetSingleElementValue(piece_state_index, 1.);
+            board_state[piece_state_index] = 1.;
+        }
+    }
+    ml_lib::SparseTensor Environment::GenerateSparseBoardState() const
+    {
+        // same encoding as GenerateBoardState, but only the (at most 32) active elements are stored
+        std::vector<unsigned int> active_indices;
+
+        for (unsigned int i = 0; i < m_piece_positions.size(); i++)
+        {
+            int piece_position = m_piece_positions[i];
+            int piece_index = i;
+
+            if (piece_position < 0)
+                continue;
+
+            active_indices.push_back(piece_position + piece_index * 64);
         }
 
-        return state;
+        return ml_lib::SparseTensor(2048, {active_indices});
     }
     ml_lib::Tensor Environment::GenerateActionSpace() const
+    {
+        std::vector<double> action_space_values(1024, 0.);
+        FillActionSpace(action_space_values.data());
+
+        return ml_lib::Tensor({8, 8, 16, 1}, action_space_values.data());
+    }
+    void Environment::FillActionSpace(double *action_space) const
     {
         // all action_spaces are normalized to pov of active_player
         // thus if ative_player is not default pov all positions need to be mirrored
@@ -189,7 +271,6 @@ namespace chess_agent
         // index of first piece which belongs to active_player
         int first_player_piece_id = active_player == cFirstIdPieceColour ? 0 : 16;
 
-        auto action_space = ml_lib::Tensor::Zeros({8, 8, 16, 1});
         auto legal_moves = m_game.get_legal_moves();
 
         int cur_relatice_id, cur_from;
@@ -198,20 +279,20 @@ namespace chess_agent
 
         for (chess::Move cur_legal_move : legal_moves)
         {
-            int cur_to_board_pos = cur_legal_move.m_to;
+            int cur_to_board_pos = cur_legal_move.get_to();
 
-            if (cur_legal_move.m_from != cur_from)
+            if (cur_legal_move.get_from() != cur_from)
             {
                 // if the legal_move from is not the same as before, the piece changed
                 // thus the piece_id has changed and needs to be updated
 
-                cur_from = cur_legal_move.m_from;
+                cur_from = cur_legal_move.get_from();
 
                 for (int i = first_player_piece_id; i - first_player_piece_id < 16; i++)
                     // for all pieces which belong to the active player (first_piece_index till firstpiece_index + 16)
-                    if (m_piece_positions[i] == cur_legal_move.m_from)
+                    if (m_piece_positions[i] == cur_legal_move.get_from())
                     {
-                        // find the index of the piece on cur_legal_move.m_from
+                        // find the index of the piece on cur_legal_move.get_from()
                         cur_relatice_id = i;
                         break;
                     }
@@ -223,10 +304,44 @@ namespace chess_agent
                 cur_to_board_pos = MirrorBoardPosition(cur_to_board_pos);
 
             int cur_to_action_pos = cur_to_board_pos + cur_id * 64;
-            action_space.SetSingleElementValue(1., cur_to_action_pos);
+            action_space[cur_to_action_pos] = 1.;
         }
+    }
+
+    void Environment::UpdateLinkedAccumulators(const std::array<int, 32> &previous_piece_positions)
+    {
+        // a move only changes the position of the moving piece and of a captured piece
+        // thus only their features have to be removed from and added to the accumulators
+        for (auto &[accumulator, pov] : m_linked_accumulators)
+        {
+            bool mirror = pov != cDefaultViewPoint;
+
+            // every move is one undo frame
+            accumulator->Push();
+
+            for (unsigned int i = 0; i < m_piece_positions.size(); i++)
+            {
+                int previous_position = previous_piece_positions[i];
+                int position = m_piece_positions[i];
+
+                if (previous_position == position)
+                    continue;
+
+                if (previous_position >= 0)
+                    accumulator->RemoveFeature((mirror ? MirrorBoardPosition(previous_position) : previous_position) + i * 64);
+
+                if (position >= 0)
+                    accumulator->AddFeature((mirror ? MirrorBoardPosition(position) : position) + i * 64);
+            }
+        }
+    }
+    void Environment::RefreshLinkedAccumulators()
+    {
+        auto board_state = GenerateSparseBoardState();
+        auto mirrored_board_state = SwitchBoardStatePov(board_state);
 
-        return action_space;
+        for (auto &[accumulator, pov] : m_linked_accumulators)
+            accumulator->Refresh(pov == cDefaultViewPoint ? board_state : mirrored_board_state);
     }
 
     std::array<int, 32> Environment::BasicPiecePositions()
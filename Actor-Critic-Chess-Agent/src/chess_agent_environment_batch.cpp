@@ -0,0 +1,110 @@
+#include "actor-critic-chess-agent/environment.h"
+
+namespace chess_agent
+{
+    EnvironmentBatch::EnvironmentBatch(const unsigned int &num_environments, const unsigned int &max_moves_per_game) : m_environments(num_environments),
+                                                                                                                        m_max_moves_per_game(max_moves_per_game),
+                                                                                                                        m_num_moves(num_environments, 0U),
+                                                                                                                        m_final_active_players(num_environments, chess::Piece::Colour::None),
+                                                                                                                        m_final_board_states(num_environments, ml_lib::SparseTensor::Empty()),
+                                                                                                                        m_board_state_values(2048 * num_environments, 0.),
+                                                                                                                        m_action_space_values(1024 * num_environments, 0.)
+    {
+        if (num_environments == 0)
+            throw std::invalid_argument("num_environments needs to be at least 1!");
+    }
+
+    void EnvironmentBatch::GenerateBoardStates(ml_lib::Tensor &board_states)
+    {
+        if (board_states.get_num_elements() != m_board_state_values.size())
+            throw std::invalid_argument("board_states needs the shape {8, 8, 16, 2, num_environments}!");
+
+        std::fill(m_board_state_values.begin(), m_board_state_values.end(), 0.);
+
+        for (unsigned int i = 0; i < m_environments.size(); i++)
+            m_environments[i].FillBoardState(m_board_state_values.data() + i * 2048);
+
+        board_states.SetElementValues(m_board_state_values.data());
+    }
+    ml_lib::SparseTensor EnvironmentBatch::GenerateSparseBoardStates() const
+    {
+        std::vector<std::vector<unsigned int>> active_indices(m_environments.size());
+
+        for (unsigned int i = 0; i < m_environments.size(); i++)
+            active_indices[i] = m_environments[i].GenerateSparseBoardState().get_active_indices(0);
+
+        return ml_lib::SparseTensor(2048, active_indices);
+    }
+    void EnvironmentBatch::GenerateActionSpaces(ml_lib::Tensor &action_spaces)
+    {
+        if (action_spaces.get_num_elements() != m_action_space_values.size())
+            throw std::invalid_argument("action_spaces needs the shape {8, 8, 16, num_environments}!");
+
+        std::fill(m_action_space_values.begin(), m_action_space_values.end(), 0.);
+
+        for (unsigned int i = 0; i < m_environments.size(); i++)
+            m_environments[i].FillActionSpace(m_action_space_values.data() + i * 1024);
+
+        action_spaces.SetElementValues(m_action_space_values.data());
+    }
+
+    std::vector<bool> EnvironmentBatch::Step(const std::vector<chess::Move> &moves)
+    {
+        if (moves.size() != m_environments.size())
+            throw std::invalid_argument("one move per environment needed!");
+
+        std::vector<bool> game_finished(m_environments.size(), false);
+
+        for (unsigned int i = 0; i < m_environments.size(); i++)
+        {
+            Environment &env = m_environments[i];
+
+            bool gameover = env.MovePiece(moves[i]);
+            m_num_moves[i]++;
+
+            if (!gameover && (m_max_moves_per_game == 0 || m_num_moves[i] < m_max_moves_per_game))
+                continue;
+
+            // keep the terminal state, the environment starts its next game right away
+            m_final_active_players[i] = env.get_active_player();
+            m_final_board_states[i] = env.GenerateSparseBoardState();
+
+            env.Reset();
+            m_num_moves[i] = 0;
+
+            game_finished[i] = true;
+        }
+
+        return game_finished;
+    }
+    void EnvironmentBatch::Reset()
+    {
+        for (unsigned int i = 0; i < m_environments.size(); i++)
+        {
+            m_environments[i].Reset();
+            m_num_moves[i] = 0;
+        }
+    }
+
+    Environment &EnvironmentBatch::get_environment(const unsigned int &index)
+    {
+        return m_environments.at(index);
+    }
+    const Environment &EnvironmentBatch::get_environment(const unsigned int &index) const
+    {
+        return m_environments.at(index);
+    }
+    unsigned int EnvironmentBatch::get_num_environments() const
+    {
+        return m_environments.size();
+    }
+
+    chess::Piece::Colour EnvironmentBatch::get_final_active_player(const unsigned int &index) const
+    {
+        return m_final_active_players.at(index);
+    }
+    ml_lib::SparseTensor EnvironmentBatch::get_final_board_state(const unsigned int &index) const
+    {
+        return m_final_board_states.at(index);
+    }
+} // namespace chess_agent
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "actor-critic-chess-agent/environment.h"
+
+namespace chess_agent
+{
+    InferenceService::InferenceService(const unsigned int &max_batchsize, const std::chrono::microseconds &max_wait) : m_max_batchsize(max_batchsize),
+                                                                                                                       m_max_wait(max_wait),
+                                                                                                                       m_requests(),
+                                                                                                                       m_num_queued_batch_elements(0),
+                                                                                                                       m_stop(false)
+    {
+        if (m_max_batchsize == 0)
+            throw std::invalid_argument("max_batchsize needs to be at least 1!");
+
+        m_thread = std::thread(&InferenceService::Run, this);
+    }
+    InferenceService::~InferenceService()
+    {
+        // pending requests are still answered
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+
+        m_thread.join();
+    }
+
+    std::future<ml_lib::Tensor> InferenceService::Submit(const std::shared_ptr<const ActorSnapshot> &actor_snapshot,
+                                                         const ml_lib::Tensor &first_layer_out,
+                                                         const ml_lib::Tensor &action_space)
+    {
+        Request request = {std::chrono::steady_clock::now(),
+                           actor_snapshot,
+                           first_layer_out,
+                           action_space,
+                           std::promise<ml_lib::Tensor>()};
+
+        if (first_layer_out.get_dimensions() != 2 || action_space.get_num_elements() != 1024 * first_layer_out.get_shape()[1])
+            throw std::invalid_argument("first_layer_out and action_space need the same batchsize!");
+
+        std::future<ml_lib::Tensor> action_prop_distr = request.action_prop_distr.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_num_queued_batch_elements += first_layer_out.get_shape()[1];
+            m_requests.push_back(std::move(request));
+        }
+        m_condition.notify_all();
+
+        return action_prop_distr;
+    }
+
+    void InferenceService::Run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            m_condition.wait(lock, [this]() { return m_requests.size() > 0 || m_stop; });
+
+            if (m_requests.size() == 0)
+                return;
+
+            // give concurrent games the chance to fill the batch
+            auto deadline = m_requests.front().submit_time + m_max_wait;
+            m_condition.wait_until(lock, deadline, [this]() { return m_num_queued_batch_elements >= m_max_batchsize || m_stop; });
+
+            std::shared_ptr<const ActorSnapshot> actor_snapshot = m_requests.front().actor_snapshot;
+            std::vector<Request> batch;
+            unsigned int batchsize = 0;
+
+            for (auto it = m_requests.begin(); it != m_requests.end();)
+            {
+                unsigned int request_batchsize = it->first_layer_out.get_shape()[1];
+
+                // the first request is always taken, even if it exceeds max_batchsize on its own
+                if (batch.size() > 0 && batchsize + request_batchsize > m_max_batchsize)
+                    break;
+
+                if (it->actor_snapshot == actor_snapshot)
+                {
+                    batchsize += request_batchsize;
+                    m_num_queued_batch_elements -= request_batchsize;
+
+                    batch.push_back(std::move(*it));
+                    it = m_requests.erase(it);
+                }
+                else
+                {
+                    it++;
+                }
+            }
+
+            lock.unlock();
+            RunBatch(*actor_snapshot, batch);
+            lock.lock();
+        }
+    }
+    void InferenceService::RunBatch(const ActorSnapshot &actor_snapshot, std::vector<Request> &batch)
+    {
+        try
+        {
+            // gather all requests into one {..., batchsize} input
+            unsigned int first_layer_size = batch[0].first_layer_out.get_shape()[0];
+            unsigned int batchsize = 0;
+
+            for (const Request &request : batch)
+            {
+                if (request.first_layer_out.get_shape()[0] != first_layer_size)
+                    throw std::invalid_argument("requests need to have the same shape!");
+
+                batchsize += request.first_layer_out.get_shape()[1];
+            }
+
+            std::vector<double> first_layer_values(first_layer_size * batchsize);
+            std::vector<double> action_space_values(1024 * batchsize);
+
+            unsigned int batch_offset = 0;
+            for (const Request &request : batch)
+            {
+                request.first_layer_out.CopyElementValues(first_layer_values.data() + batch_offset * first_layer_size);
+                request.action_space.CopyElementValues(action_space_values.data() + batch_offset * 1024);
+
+                batch_offset += request.first_layer_out.get_shape()[1];
+            }
+
+            ml_lib::Tensor first_layer_out({first_layer_size, batchsize}, first_layer_values.data());
+            ml_lib::Tensor action_space({8, 8, 16, batchsize}, action_space_values.data());
+
+            ml_lib::Tensor out = ActorFeedForwardFromFirstLayer(first_layer_out, action_space, actor_snapshot.get_model());
+
+            // scatter the batch back to the requests
+            std::vector<double> out_values(out.get_num_elements());
+            out.CopyElementValues(out_values.data());
+
+            batch_offset = 0;
+            for (Request &request : batch)
+            {
+                unsigned int request_batchsize = request.first_layer_out.get_shape()[1];
+
+                request.action_prop_distr.set_value(ml_lib::Tensor({8, 8, 16, request_batchsize}, out_values.data() + batch_offset * 1024));
+
+                batch_offset += request_batchsize;
+            }
+        }
+        catch (...)
+        {
+            for (Request &request : batch)
+                request.action_prop_distr.set_exception(std::current_exception());
+        }
+    }
+} // namespace chess_agent
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "actor-critic-chess-agent/environment.h"
 
+#include <cstdint>
+#include <cstring>
+
 namespace chess_agent
 {
-    Replay::Replay() : m_state(ml_lib::Tensor::Empty()),
-                       m_next_state(ml_lib::Tensor::Empty()),
+    Replay::Replay() : m_state(ml_lib::SparseTensor::Empty()),
+                       m_next_state(ml_lib::SparseTensor::Empty()),
                        m_action(ml_lib::Tensor::Empty()),
                        m_action_space(ml_lib::Tensor::Empty()),
                        m_return(ml_lib::Tensor::Empty())
@@ -11,8 +14,8 @@ namespace chess_agent
 
     }
 
-    Replay::Replay(const ml_lib::Tensor &state,
-                   const ml_lib::Tensor &next_state,
+    Replay::Replay(const ml_lib::SparseTensor &state,
+                   const ml_lib::SparseTensor &next_state,
                    const ml_lib::Tensor &action_prop_distr,
                    const ml_lib::Tensor &action_space,
                    const ml_lib::Tensor &return_) : m_state(state),
@@ -25,9 +28,9 @@ namespace chess_agent
 
     Replay Replay::Concatenate(const Replay &a, const Replay &b)
     {
-        // shape of chess state: 8, 8, 16, 2, 1
-        ml_lib::Tensor state = ml_lib::Tensor::Concatenate(a.m_state, b.m_state, 4);
-        ml_lib::Tensor next_state = ml_lib::Tensor::Concatenate(a.m_next_state, b.m_next_state, 4);
+        // shape of chess state: 2048, 1 (sparse)
+        ml_lib::SparseTensor state = ml_lib::SparseTensor::Concatenate(a.m_state, b.m_state, 1);
+        ml_lib::SparseTensor next_state = ml_lib::SparseTensor::Concatenate(a.m_next_state, b.m_next_state, 1);
 
         // shape of action: 8, 8, 16, 1
         ml_lib::Tensor action = ml_lib::Tensor::Concatenate(a.m_action, b.m_action, 3);
@@ -43,11 +46,94 @@ namespace chess_agent
                       return_);
     }
 
-    ml_lib::Tensor Replay::get_state() const
+    namespace
+    {
+        template <typename T>
+        void AppendBytes(std::vector<unsigned char> &bytes, const T &value)
+        {
+            const unsigned char *value_bytes = (const unsigned char *)&value;
+            bytes.insert(bytes.end(), value_bytes, value_bytes + sizeof(T));
+        }
+        template <typename T>
+        T ReadBytes(const unsigned char *&bytes)
+        {
+            T value;
+            std::memcpy(&value, bytes, sizeof(T));
+            bytes += sizeof(T);
+
+            return value;
+        }
+    } // namespace
+
+    void Replay::Serialize(std::vector<unsigned char> &bytes) const
+    {
+        // states are one-hot, the action is zero outside of the action space
+        // thus only the active indices of the states and the action space (with their action values) are stored
+        for (const ml_lib::SparseTensor &state : {m_state, m_next_state})
+        {
+            std::vector<unsigned int> active_indices = state.get_active_indices(0);
+
+            AppendBytes<std::uint32_t>(bytes, active_indices.size());
+            for (const unsigned int &index : active_indices)
+                AppendBytes<std::uint32_t>(bytes, index);
+        }
+
+        std::vector<std::uint32_t> action_indices;
+        for (unsigned int i = 0; i < m_action_space.get_num_elements(); i++)
+        {
+            if (m_action_space.get_element_value_at(i) != 0.)
+                action_indices.push_back(i);
+        }
+
+        AppendBytes<std::uint32_t>(bytes, action_indices.size());
+        for (const std::uint32_t &index : action_indices)
+        {
+            AppendBytes<std::uint32_t>(bytes, index);
+            AppendBytes<double>(bytes, m_action.get_element_value_at(index));
+        }
+
+        AppendBytes<double>(bytes, m_return.get_element_value_at(0));
+    }
+    Replay Replay::Deserialize(const unsigned char *&bytes)
+    {
+        std::vector<ml_lib::SparseTensor> states;
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            std::vector<unsigned int> active_indices(ReadBytes<std::uint32_t>(bytes));
+            for (unsigned int &index : active_indices)
+                index = ReadBytes<std::uint32_t>(bytes);
+
+            states.push_back(ml_lib::SparseTensor(2048, {active_indices}));
+        }
+
+        std::vector<double> action_values(1024, 0.);
+        std::vector<double> action_space_values(1024, 0.);
+
+        std::uint32_t num_actions = ReadBytes<std::uint32_t>(bytes);
+        for (std::uint32_t i = 0; i < num_actions; i++)
+        {
+            std::uint32_t index = ReadBytes<std::uint32_t>(bytes);
+            if (index >= 1024)
+                throw std::invalid_argument("action index out of bounds!");
+
+            action_space_values[index] = 1.;
+            action_values[index] = ReadBytes<double>(bytes);
+        }
+
+        double return_ = ReadBytes<double>(bytes);
+
+        return Replay(states[0],
+                      states[1],
+                      ml_lib::Tensor({8, 8, 16, 1}, action_values.data()),
+                      ml_lib::Tensor({8, 8, 16, 1}, action_space_values.data()),
+                      ml_lib::Tensor::Scalar(return_));
+    }
+
+    ml_lib::SparseTensor Replay::get_state() const
     {
         return m_state;
     }
-    ml_lib::Tensor Replay::get_next_state() const
+    ml_lib::SparseTensor Replay::get_next_state() const
     {
         return m_next_state;
     }
@@ -0,0 +1,174 @@
+#include "actor-critic-chess-agent/environment.h"
+
+#include <random>
+#include <algorithm>
+
+const double cEpsilonDecayA = 0.5;
+const double cEpsilonDecayB = 0.1;
+const double cEpsylonDecayC = 0.1;
+
+const int max_round_per_game = 50;
+
+ml_lib::Tensor GenerateReturn(const chess::Piece::Colour& winner, const chess::Piece::Colour& cur_player) {
+    if(winner == cur_player)
+        return ml_lib::Tensor::Scalar(1.);
+    else
+        return ml_lib::Tensor::Scalar(0.);
+}
+
+bool EpsylonGreedy(const int& t, const int& epochs, std::mt19937& rng) {
+    double standardized_time = (t-cEpsilonDecayA * (double)epochs) / (cEpsilonDecayB * (double)epochs);
+    double cosh_ = cosh(exp(-standardized_time));
+    double epsilon = 1.1 - ( 1. / cosh_ + (t * cEpsylonDecayC / (double)epochs));
+
+    double rand_ = std::uniform_real_distribution<double>(0., 1.)(rng);
+
+    // returns true for actor taking action, false for random action
+    return rand_ > epsilon;
+}
+
+void SetReturns(std::vector<chess_agent::Replay>& game_replays, const chess::Piece::Colour& winner) {
+    auto cur_player = chess::Piece::Colour::White;
+
+    for(auto& replay: game_replays) {
+        replay.set_return(GenerateReturn(winner, cur_player));
+
+        cur_player = chess::Game::Opponent(cur_player);
+    }
+}
+
+namespace chess_agent {
+    void SelfPlay(const unsigned int& num_games,
+                  const unsigned int& seed,
+                  const int& epochs,
+                  std::atomic<int>& t,
+                  InferenceService& inference_service,
+                  const std::function<std::shared_ptr<const ActorSnapshot>()>& latest_actor_snapshot,
+                  const std::function<bool()>& start_game,
+                  const std::function<void(std::vector<Replay>&&)>& finish_game)
+    {
+        std::mt19937 rng(seed);
+
+        EnvironmentBatch env_batch(num_games, max_round_per_game);
+
+        std::shared_ptr<const ActorSnapshot> worker_actor_snapshot = latest_actor_snapshot();
+        const unsigned int first_layer_size = worker_actor_snapshot->get_first_layer()->get_output_dimensions();
+
+        // one accumulator per game, holds the first actor layer pre-activations of its board state
+        std::vector<ml_lib::Accumulator> board_state_accumulators(num_games, ml_lib::Accumulator(worker_actor_snapshot->get_first_layer()));
+        for(unsigned int i = 0; i < num_games; i++)
+            env_batch.get_environment(i).LinkAccumulator(&board_state_accumulators[i], env_batch.get_environment(i).cDefaultViewPoint);
+
+        // games which still count towards epochs, the others are played on but thrown away
+        std::vector<bool> game_counts(num_games);
+        for(unsigned int i = 0; i < num_games; i++)
+            game_counts[i] = start_game();
+
+        std::vector<std::vector<Replay>> game_replays(num_games);
+
+        // batched network inputs, reused every step
+        auto first_layer_out = ml_lib::Tensor::Zeros({first_layer_size, num_games});
+        auto action_spaces = ml_lib::Tensor::Zeros({8, 8, 16, num_games});
+
+        std::vector<double> first_layer_values(first_layer_size * num_games);
+        std::vector<double> action_space_values(1024 * num_games);
+        std::vector<double> action_prop_distr_values(1024 * num_games);
+
+        while(std::find(game_counts.begin(), game_counts.end(), true) != game_counts.end()) {
+            // a newly published snapshot is picked up between two steps
+            std::shared_ptr<const ActorSnapshot> polled_actor_snapshot = latest_actor_snapshot();
+
+            if(polled_actor_snapshot != worker_actor_snapshot) {
+                worker_actor_snapshot = polled_actor_snapshot;
+
+                for(unsigned int i = 0; i < num_games; i++) {
+                    board_state_accumulators[i].Link(worker_actor_snapshot->get_first_layer());
+                    board_state_accumulators[i].Refresh(env_batch.get_environment(i).GenerateSparseBoardState());
+                }
+            }
+
+            std::vector<ml_lib::SparseTensor> cur_states;
+            for(unsigned int i = 0; i < num_games; i++)
+                cur_states.push_back(env_batch.get_environment(i).GenerateSparseBoardState());
+
+            env_batch.GenerateActionSpaces(action_spaces);
+            action_spaces.CopyElementValues(action_space_values.data());
+
+            std::vector<bool> actor_takes_action(num_games, false);
+            for(unsigned int i = 0; i < num_games; i++)
+                actor_takes_action[i] = game_counts[i] && EpsylonGreedy(++t, epochs, rng);
+
+            if(std::find(actor_takes_action.begin(), actor_takes_action.end(), true) != actor_takes_action.end()) {
+                // one request for the whole batch, batched together with the requests of the other workers
+                for(unsigned int i = 0; i < num_games; i++)
+                    board_state_accumulators[i].CopyPreActivations(first_layer_values.data() + i * first_layer_size);
+
+                first_layer_out.SetElementValues(first_layer_values.data());
+
+                inference_service.Submit(worker_actor_snapshot, first_layer_out, action_spaces).get().CopyElementValues(action_prop_distr_values.data());
+            }
+
+            std::vector<chess::Move> actions(num_games);
+            std::vector<ml_lib::Tensor> action_prop_distrs;
+
+            for(unsigned int i = 0; i < num_games; i++) {
+                auto& env = env_batch.get_environment(i);
+
+                if(actor_takes_action[i]) {
+                    // actor takes action
+                    action_prop_distrs.push_back(ml_lib::Tensor({8, 8, 16, 1}, action_prop_distr_values.data() + i * 1024));
+
+                    actions[i] = env.ActionPropDistrToMove(action_prop_distrs[i]);
+                } else {
+                    // random action
+                    auto legal_moves = env.get_legal_moves();
+
+                    auto random_action_index = rng() % legal_moves.size();
+                    actions[i] = legal_moves[random_action_index];
+
+                    action_prop_distrs.push_back(env.MoveToActionPropDistr(actions[i]));
+                }
+            }
+
+            auto game_finished = env_batch.Step(actions);
+
+            for(unsigned int i = 0; i < num_games; i++) {
+                if(game_counts[i]) {
+                    auto& env = env_batch.get_environment(i);
+
+                    // finished games have already been reset
+                    auto cur_state = cur_states[i];
+                    auto next_state = game_finished[i] ? env_batch.get_final_board_state(i) : env.GenerateSparseBoardState();
+                    auto active_player = game_finished[i] ? env_batch.get_final_active_player(i) : env.get_active_player();
+
+                    if(active_player != env.cDefaultViewPoint) {
+                        // The agent is suppose to play against itself. That means he takes actions from pov.black and pov.white.
+                        // Normalize cur_state and next_state so both are from pov=active_player
+                        // (meaning he always views the board from his point of view)
+
+                        cur_state = Environment::SwitchBoardStatePov(cur_state);
+                        next_state = Environment::SwitchBoardStatePov(next_state);
+                    }
+
+                    game_replays[i].push_back(Replay(cur_state,
+                                                         next_state,
+                                                         action_prop_distrs[i],
+                                                         ml_lib::Tensor({8, 8, 16, 1}, action_space_values.data() + i * 1024),
+                                                         ml_lib::Tensor::Scalar(0.)));
+                }
+
+                if(!game_finished[i])
+                    continue;
+
+                if(game_counts[i]) {
+                    SetReturns(game_replays[i], env_batch.get_final_active_player(i));
+
+                    finish_game(std::move(game_replays[i]));
+                }
+
+                game_replays[i].clear();
+                game_counts[i] = start_game();
+            }
+        }
+    }
+} // namespace chess_agent
\ No newline at end of file
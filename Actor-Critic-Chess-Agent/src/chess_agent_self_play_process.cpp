@@ -0,0 +1,373 @@
+#include "actor-critic-chess-agent/environment.h"
+#include "ml_lib/checkpoint.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace chess_agent
+{
+    namespace
+    {
+        const std::uint64_t cControlMagic = 0x59414c50464c4553; // "SELFPLAY"
+
+        // first block of the shared memory, followed by the weight seqlock and the trajectory ring
+        struct SelfPlayControl
+        {
+            alignas(ml_lib::shared_memory::cCacheLineSize) std::uint64_t magic;
+            std::uint64_t weights_offset;
+            std::uint64_t trajectories_offset;
+
+            std::int32_t epochs;
+            std::uint32_t num_processes;
+            std::uint32_t games_per_process;
+            std::uint32_t seed;
+            std::uint32_t inference_max_batchsize;
+            std::uint32_t pin_to_numa_nodes;
+            std::int64_t inference_max_wait_us;
+
+            alignas(ml_lib::shared_memory::cCacheLineSize) std::atomic<int> games_started;
+            alignas(ml_lib::shared_memory::cCacheLineSize) std::atomic<int> t;
+
+            // games an actor has started but not pushed yet, they are lost if the actor crashes
+            alignas(ml_lib::shared_memory::cCacheLineSize) std::atomic<int> games_in_flight[SelfPlayProcesses::cMaxProcesses];
+        };
+        static_assert(std::atomic<int>::is_always_lock_free, "shared memory needs lock-free atomics");
+
+        std::size_t AlignToCacheLine(const std::size_t &size)
+        {
+            return (size + ml_lib::shared_memory::cCacheLineSize - 1) / ml_lib::shared_memory::cCacheLineSize * ml_lib::shared_memory::cCacheLineSize;
+        }
+
+        std::size_t CountWeights(const std::vector<ml_lib::LayerBase *> &actor_model)
+        {
+            std::size_t num_weights = 0;
+
+            for (const ml_lib::Tensor *parameter : ml_lib::checkpoint::CollectParameters(actor_model))
+                num_weights += parameter->get_num_elements();
+
+            return num_weights;
+        }
+        std::size_t WeightsOffset()
+        {
+            return AlignToCacheLine(sizeof(SelfPlayControl));
+        }
+        std::size_t TrajectoriesOffset(const std::size_t &num_weights)
+        {
+            return WeightsOffset() + AlignToCacheLine(ml_lib::shared_memory::Seqlock::RequiredSize(num_weights));
+        }
+
+        // trajectory message: number of replays followed by the serialized replays
+        void SerializeTrajectory(const std::vector<Replay> &game_replays, std::vector<unsigned char> &message)
+        {
+            std::uint32_t num_replays = game_replays.size();
+
+            message.resize(sizeof(num_replays));
+            std::memcpy(message.data(), &num_replays, sizeof(num_replays));
+
+            for (const Replay &replay : game_replays)
+                replay.Serialize(message);
+        }
+        std::vector<Replay> DeserializeTrajectory(const std::vector<unsigned char> &message)
+        {
+            const unsigned char *bytes = message.data();
+
+            std::uint32_t num_replays;
+            std::memcpy(&num_replays, bytes, sizeof(num_replays));
+            bytes += sizeof(num_replays);
+
+            std::vector<Replay> game_replays;
+            for (std::uint32_t i = 0; i < num_replays; i++)
+                game_replays.push_back(Replay::Deserialize(bytes));
+
+            return game_replays;
+        }
+
+        bool PinToNumaNode(const unsigned int &actor_id)
+        {
+            // the cpus of a node are listed like "0-3,8-11"
+            std::vector<std::string> node_cpulists;
+
+            for (unsigned int node = 0;; node++)
+            {
+                std::ifstream cpulist_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                if (!cpulist_file)
+                    break;
+
+                std::string cpulist;
+                std::getline(cpulist_file, cpulist);
+                node_cpulists.push_back(cpulist);
+            }
+
+            if (node_cpulists.size() == 0)
+                return false;
+
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+
+            std::stringstream cpulist(node_cpulists[actor_id % node_cpulists.size()]);
+            std::string cpu_range;
+            while (std::getline(cpulist, cpu_range, ','))
+            {
+                if (cpu_range.empty())
+                    continue;
+
+                std::size_t separator = cpu_range.find('-');
+                unsigned int first_cpu = std::stoul(cpu_range.substr(0, separator));
+                unsigned int last_cpu = separator == std::string::npos ? first_cpu : std::stoul(cpu_range.substr(separator + 1));
+
+                for (unsigned int cpu = first_cpu; cpu <= last_cpu && cpu < CPU_SETSIZE; cpu++)
+                    CPU_SET(cpu, &cpus);
+            }
+
+            return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+        }
+    } // namespace
+
+    SelfPlayProcesses::SelfPlayProcesses(const unsigned int &num_processes,
+                                         const int &epochs,
+                                         const std::vector<ml_lib::LayerBase *> &actor_model,
+                                         const unsigned int &games_per_process,
+                                         const unsigned int &seed,
+                                         const unsigned int &inference_max_batchsize,
+                                         const std::chrono::microseconds &inference_max_wait,
+                                         const std::size_t &trajectory_ring_capacity,
+                                         const std::size_t &trajectory_slot_size,
+                                         const bool &pin_to_numa_nodes) : m_region(ml_lib::shared_memory::Region::Create("/chess_agent_self_play_" + std::to_string(getpid()),
+                                                                                                                          TrajectoriesOffset(CountWeights(actor_model)) +
+                                                                                                                              ml_lib::shared_memory::Ring::RequiredSize(trajectory_ring_capacity, trajectory_slot_size))),
+                                                                          m_weights(ml_lib::shared_memory::Seqlock::Initialize((unsigned char *)m_region.get_data() + WeightsOffset(),
+                                                                                                                               CountWeights(actor_model))),
+                                                                          m_trajectories(ml_lib::shared_memory::Ring::Initialize((unsigned char *)m_region.get_data() + TrajectoriesOffset(CountWeights(actor_model)),
+                                                                                                                                 trajectory_ring_capacity,
+                                                                                                                                 trajectory_slot_size)),
+                                                                          m_pids(num_processes, 0),
+                                                                          m_weight_values(CountWeights(actor_model)),
+                                                                          m_message()
+    {
+        if (num_processes == 0 || num_processes > cMaxProcesses)
+            throw std::invalid_argument("num_processes out of bounds!");
+
+        SelfPlayControl *control = new (m_region.get_data()) SelfPlayControl();
+        control->weights_offset = WeightsOffset();
+        control->trajectories_offset = TrajectoriesOffset(m_weight_values.size());
+        control->epochs = epochs;
+        control->num_processes = num_processes;
+        control->games_per_process = games_per_process;
+        control->seed = seed;
+        control->inference_max_batchsize = inference_max_batchsize;
+        control->pin_to_numa_nodes = pin_to_numa_nodes;
+        control->inference_max_wait_us = inference_max_wait.count();
+        control->games_started.store(0);
+        control->t.store(0);
+        for (std::atomic<int> &games_in_flight : control->games_in_flight)
+            games_in_flight.store(0);
+
+        std::atomic_thread_fence(std::memory_order_release);
+        control->magic = cControlMagic;
+
+        // actors wait for the first weights
+        PublishWeights(actor_model);
+
+        for (unsigned int actor_id = 0; actor_id < num_processes; actor_id++)
+            Spawn(actor_id);
+    }
+    SelfPlayProcesses::~SelfPlayProcesses()
+    {
+        // games still in progress are not needed anymore
+        for (pid_t &pid : m_pids)
+        {
+            if (pid <= 0)
+                continue;
+
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    std::vector<Replay> SelfPlayProcesses::PopTrajectory()
+    {
+        for (unsigned int attempt = 0; !m_trajectories.TryPop(m_message); attempt++)
+        {
+            SuperviseProcesses();
+
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        return DeserializeTrajectory(m_message);
+    }
+    void SelfPlayProcesses::PublishWeights(const std::vector<ml_lib::LayerBase *> &actor_model)
+    {
+        std::size_t offset = 0;
+
+        for (const ml_lib::Tensor *parameter : ml_lib::checkpoint::CollectParameters(actor_model))
+        {
+            if (offset + parameter->get_num_elements() > m_weight_values.size())
+                throw std::invalid_argument("actor_model does not match the published weights!");
+
+            parameter->CopyElementValues(m_weight_values.data() + offset);
+            offset += parameter->get_num_elements();
+        }
+
+        m_weights.Write(m_weight_values.data());
+    }
+
+    void SelfPlayProcesses::Spawn(const unsigned int &actor_id)
+    {
+        std::string shm_name = m_region.get_name();
+        std::string actor_id_string = std::to_string(actor_id);
+
+        char *argv[] = {(char *)"main", (char *)"--self-play-actor", shm_name.data(), actor_id_string.data(), nullptr};
+
+        pid_t pid;
+        if (posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, argv, environ) != 0)
+            throw std::runtime_error("failed to start self-play actor " + actor_id_string + "!");
+
+        m_pids[actor_id] = pid;
+    }
+    void SelfPlayProcesses::SuperviseProcesses()
+    {
+        SelfPlayControl *control = (SelfPlayControl *)m_region.get_data();
+        unsigned int num_running = 0;
+
+        for (unsigned int actor_id = 0; actor_id < m_pids.size(); actor_id++)
+        {
+            if (m_pids[actor_id] <= 0)
+                continue;
+
+            int status;
+            if (waitpid(m_pids[actor_id], &status, WNOHANG) == 0)
+            {
+                num_running++;
+                continue;
+            }
+
+            m_pids[actor_id] = 0;
+
+            // a clean exit means there were no more games to start
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+                continue;
+
+            std::cout << "[-] self-play actor " << actor_id << " crashed, restarting" << std::endl;
+
+            // the games it had started are handed to the others (or the restarted actor) again
+            control->games_started.fetch_sub(control->games_in_flight[actor_id].exchange(0));
+
+            Spawn(actor_id);
+            num_running++;
+        }
+
+        if (num_running == 0 && m_trajectories.get_depth() == 0)
+            throw std::runtime_error("all self-play actors exited, but the learner needs more games!");
+    }
+
+    void RunSelfPlayProcess(const std::string &shm_name, const unsigned int &actor_id, const std::vector<ml_lib::LayerBase *> &actor_model)
+    {
+        // actors do not outlive the learner
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+        ml_lib::shared_memory::Region region = ml_lib::shared_memory::Region::Open(shm_name);
+
+        SelfPlayControl *control = (SelfPlayControl *)region.get_data();
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (region.get_size() < sizeof(SelfPlayControl) || control->magic != cControlMagic)
+            throw std::runtime_error(shm_name + " is not a self-play memory!");
+        if (actor_id >= control->num_processes)
+            throw std::invalid_argument("actor_id out of bounds!");
+
+        ml_lib::shared_memory::Seqlock weights = ml_lib::shared_memory::Seqlock::Attach((unsigned char *)region.get_data() + control->weights_offset);
+        ml_lib::shared_memory::Ring trajectories = ml_lib::shared_memory::Ring::Attach((unsigned char *)region.get_data() + control->trajectories_offset);
+
+        if (control->pin_to_numa_nodes && PinToNumaNode(actor_id))
+            std::cout << "[+] self-play actor " << actor_id << " pinned to its numa node" << std::endl;
+
+        std::vector<ml_lib::Tensor *> parameters = ml_lib::checkpoint::CollectParameters(actor_model);
+        std::vector<double> weight_values(weights.get_num_values());
+
+        if (CountWeights(actor_model) != weight_values.size())
+            throw std::invalid_argument("actor_model does not match the published weights!");
+
+        std::shared_ptr<const ActorSnapshot> actor_snapshot;
+        std::uint64_t weights_version = 0;
+
+        auto read_weights = [&]()
+        {
+            std::uint64_t version;
+            if (!weights.TryRead(weight_values.data(), version))
+                return false;
+
+            std::size_t offset = 0;
+            for (ml_lib::Tensor *parameter : parameters)
+            {
+                parameter->SetElementValues(weight_values.data() + offset);
+                offset += parameter->get_num_elements();
+            }
+
+            actor_snapshot = ActorSnapshot::Make(actor_model);
+            weights_version = version;
+
+            return true;
+        };
+
+        // the learner publishes the first weights before starting the actors
+        while (weights.get_version() == 0 || !read_weights())
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+        auto latest_actor_snapshot = [&]()
+        {
+            // a read which overlaps with the learner writing is simply retried at the next poll
+            if (weights.get_version() != weights_version)
+                read_weights();
+
+            return actor_snapshot;
+        };
+        auto start_game = [&]()
+        {
+            control->games_in_flight[actor_id].fetch_add(1);
+
+            // games_started never exceeds epochs, thus the games of a crashed actor can be handed back
+            int games_started = control->games_started.load();
+            while (games_started < control->epochs && !control->games_started.compare_exchange_weak(games_started, games_started + 1))
+                ;
+
+            if (games_started < control->epochs)
+                return true;
+
+            control->games_in_flight[actor_id].fetch_sub(1);
+            return false;
+        };
+        std::vector<unsigned char> message;
+        auto finish_game = [&](std::vector<Replay> &&game_replays)
+        {
+            SerializeTrajectory(game_replays, message);
+            trajectories.Push(message.data(), message.size());
+
+            // a crash right after the push hands the game back and it is played twice
+            // the learner pops exactly epochs trajectories, thus the duplicate is never waited for
+            control->games_in_flight[actor_id].fetch_sub(1);
+        };
+
+        InferenceService inference_service(std::min(control->games_per_process, control->inference_max_batchsize),
+                                           std::chrono::microseconds(control->inference_max_wait_us));
+
+        SelfPlay(control->games_per_process,
+                 control->seed + actor_id,
+                 control->epochs,
+                 control->t,
+                 inference_service,
+                 latest_actor_snapshot,
+                 start_game,
+                 finish_game);
+    }
+} // namespace chess_agent
\ No newline at end of file
@@ -9,6 +9,14 @@ namespace chess_agent{
 
         chess_agent::Environment env;
 
+        // the agent views the board from its (black) pov
+        auto actor_first_layer = dynamic_cast<const ml_lib::layer_type::Linear*>(actor_model[0]);
+        if(actor_first_layer == nullptr)
+            throw std::invalid_argument("first actor layer needs to be linear!");
+
+        ml_lib::Accumulator board_state_accumulator(actor_first_layer);
+        env.LinkAccumulator(&board_state_accumulator, chess::Piece::Colour::Black);
+
         while(true) {
             // commandline takes action
             LOG("Commandline takes action!");
@@ -31,13 +39,9 @@ namespace chess_agent{
             LOG("Agent takes action!");
             LOG(env.get_board().ToString());
 
-            auto board_state = env.GenerateBoardState();
             auto action_space = env.GenerateActionSpace();
 
-            if(env.get_active_player() != env.cDefaultViewPoint)
-                board_state = env.SwitchBoardStatePov(board_state);
-
-            auto agent_action_prop_distr = chess_agent::ActorFeedForward(board_state, action_space, actor_model);
+            auto agent_action_prop_distr = chess_agent::ActorFeedForward(board_state_accumulator, action_space, actor_model);
             chess::Move agent_action = env.ActionPropDistrToMove(agent_action_prop_distr);
 
             if(env.MovePiece(agent_action))
@@ -1,55 +1,67 @@
 #include "actor-critic-chess-agent/environment.h"
+#include "ml_lib/checkpoint.h"
+#include "ml_lib/mpmc_queue.h"
+
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 #define BATCHSIZE 1
 
 const int cReplayMemorySize = 100;
-const double cEpsilonDecayA = 0.5;
-const double cEpsilonDecayB = 0.1;
-const double cEpsylonDecayC = 0.1;
 
-const int max_round_per_game = 50;
+const char* cCheckpointPathPrefix = "training";
+const int cNumKeptCheckpoints = 3;
+const int cCheckpointIntervalGames = 100;
+const double cCheckpointIntervalSeconds = 600.;
 
-ml_lib::Tensor CriticFeedForward(const ml_lib::Tensor& board_state, const ml_lib::Tensor& action_prop_distr, std::vector<ml_lib::LayerBase*> critic_model) {
-    // board_state shape: {8, 8, 16, 2, 1}
-    // action_prop_distr shape {8, 8, 16, 1}
-    unsigned int batchsize = action_prop_distr.get_num_elements() / 1024;
-    auto action_prop_distr_ = action_prop_distr.Reshape({8, 8, 16, 1, batchsize});
+// 0: one self-play worker per hardware thread (minus the learner)
+const unsigned int cNumSelfPlayWorkers = 0;
+const unsigned int cSelfPlaySeed = 0;
 
-    auto out = ml_lib::Tensor::Concatenate(board_state, action_prop_distr_, 3);
+// every self-play worker steps this many games in lockstep
+const unsigned int cGamesPerSelfPlayWorker = 8;
 
-    out = out.Reshape({3072, batchsize});
+// finished games waiting for the learner, has to be a power of two
+const std::size_t cTrajectoryQueueCapacity = 64;
 
-    for(auto layer: critic_model) {
-        out = layer->FeedForward(out);
-    }
+// > 0: self-play runs in that many separate actor processes instead of worker threads
+const unsigned int cNumSelfPlayProcesses = 0;
+const bool cPinSelfPlayProcessesToNumaNodes = true;
+// bytes per trajectory in the shared memory ring, large enough for max_round_per_game moves with all legal actions
+const std::size_t cTrajectorySlotSize = 256 * 1024;
 
-    return out;
-}
+// batch elements (games) per inference batch
+const unsigned int cInferenceMaxBatchsize = 64;
+const std::chrono::microseconds cInferenceMaxWait(200);
 
-ml_lib::Tensor GenerateReturn(const chess::Piece::Colour& winner, const chess::Piece::Colour& cur_player) {
-    if(winner == cur_player)
-        return ml_lib::Tensor::Scalar(1.);
-    else
-        return ml_lib::Tensor::Scalar(0.);
-}
+ml_lib::Tensor chess_agent::CriticFeedForward(const ml_lib::SparseTensor& board_state, const ml_lib::Tensor& action_prop_distr, const ml_lib::Tensor& action_space, std::vector<ml_lib::LayerBase*> critic_model) {
+    // board_state shape: {2048, 1} (sparse)
+    // action_prop_distr shape {8, 8, 16, 1}
+    // action_prop_distr is masked by action_space, thus only its legal actions have to be fed into the first layer
+    auto action_support = ml_lib::SparseTensor::FromDense(action_space);
+    auto sparse_action_prop_distr = ml_lib::SparseTensor::Gather(action_prop_distr, action_support);
 
-bool EpsylonGreedy(const int& epochs) {
-    static int t = 0;
-    t += 1;
-    
-    double standardized_time = (t-cEpsilonDecayA * (double)epochs) / (cEpsilonDecayB * (double)epochs);
-    double cosh_ = cosh(exp(-standardized_time));
-    double epsilon = 1.1 - ( 1. / cosh_ + (t * cEpsylonDecayC / (double)epochs));
+    auto in = ml_lib::SparseTensor::Concatenate(board_state, sparse_action_prop_distr, 0);
 
-    double rand_ = (double)rand() / (double)RAND_MAX;
+    auto out = critic_model[0]->FeedForward(in);
+
+    for(unsigned int i = 1; i < critic_model.size(); i++) {
+        out = critic_model[i]->FeedForward(out);
+    }
 
-    // returns true for actor taking action, false for random action
-    return rand_ > epsilon;
+    return out;
 }
 
 namespace chess_agent {
     void train(const int& epochs, std::vector<ml_lib::LayerBase*>& actor_model)
     {
+        // self-play workers play games with a snapshot of the actor and fill the replay memory
+        // the learner takes one training step per finished game and publishes a new snapshot afterwards
         ml_lib::layer_type::Linear critic_l1(3072, 1000, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
         ml_lib::layer_type::Linear critic_l2(1000, 500, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
         ml_lib::layer_type::Linear critic_l3(500, 1, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
@@ -60,106 +72,128 @@ namespace chess_agent {
         ml_lib::optimizer::MiniBatchSgd critic_optimizer(critic_model, 0.1);
 
 
-        chess_agent::Environment env;
-        ml_lib::ReplayMemory<chess_agent::Replay> rm(cReplayMemorySize);
-
-        for(unsigned int epoch_id = 0; epoch_id < epochs; epoch_id++) {
-            std::cout << "[+] " << epoch_id << ". Round begins!" << std::endl;
-
-            env.Reset();
-
-            // play one game
-            bool gameover = false;
-            int game_index = 0;
-
-            std::vector<chess_agent::Replay> game_replays;
-            auto next_state = env.GenerateBoardState();
-
-            while(!gameover && game_index <= max_round_per_game) {
-                game_index++;
-
-                auto cur_state = std::move(next_state);
+        // checkpoints are written in the background, training continues meanwhile
+        ml_lib::checkpoint::AsyncWriter checkpoint_writer(cCheckpointPathPrefix,
+                                                          cNumKeptCheckpoints,
+                                                          cCheckpointIntervalGames,
+                                                          cCheckpointIntervalSeconds);
+        checkpoint_writer.Track("actor", actor_optimizer.get_learnable_parameters());
+        checkpoint_writer.Track("critic", critic_optimizer.get_learnable_parameters());
 
-                auto action_space = env.GenerateActionSpace();
+        ml_lib::ReplayMemory<chess_agent::Replay> rm(cReplayMemorySize);
 
-                auto action_prop_distr = ml_lib::Tensor::Empty();
-                chess::Move action;
+        std::shared_ptr<const chess_agent::ActorSnapshot> actor_snapshot = chess_agent::ActorSnapshot::Make(actor_model);
+        std::mutex actor_snapshot_mutex;
+
+        std::atomic<int> games_started(0);
+        std::atomic<int> t(0);
+
+        // finished games (trajectories) are handed from the self-play workers to the learner
+        // workers wait when the learner falls behind
+        ml_lib::MpmcQueue<std::vector<chess_agent::Replay>> trajectory_queue(cTrajectoryQueueCapacity);
+
+        unsigned int num_workers = cNumSelfPlayWorkers;
+        if(num_workers == 0)
+            num_workers = std::max(2U, std::thread::hardware_concurrency()) - 1;
+
+        chess_agent::InferenceService inference_service(std::min(num_workers * cGamesPerSelfPlayWorker, cInferenceMaxBatchsize), cInferenceMaxWait);
+
+        auto self_play_worker = [&](const unsigned int& worker_id) {
+            auto latest_actor_snapshot = [&]() {
+                std::lock_guard<std::mutex> lock(actor_snapshot_mutex);
+                return actor_snapshot;
+            };
+            auto start_game = [&]() {
+                return games_started.fetch_add(1) < epochs;
+            };
+            auto finish_game = [&](std::vector<chess_agent::Replay>&& game_replays) {
+                trajectory_queue.Push(std::move(game_replays));
+            };
+
+            chess_agent::SelfPlay(cGamesPerSelfPlayWorker,
+                                  cSelfPlaySeed + worker_id,
+                                  epochs,
+                                  t,
+                                  inference_service,
+                                  latest_actor_snapshot,
+                                  start_game,
+                                  finish_game);
+        };
+
+        std::unique_ptr<chess_agent::SelfPlayProcesses> self_play_processes;
+        if(cNumSelfPlayProcesses > 0)
+            self_play_processes = std::make_unique<chess_agent::SelfPlayProcesses>(cNumSelfPlayProcesses,
+                                                                                   epochs,
+                                                                                   actor_model,
+                                                                                   cGamesPerSelfPlayWorker,
+                                                                                   cSelfPlaySeed,
+                                                                                   cInferenceMaxBatchsize,
+                                                                                   cInferenceMaxWait,
+                                                                                   cTrajectoryQueueCapacity,
+                                                                                   cTrajectorySlotSize,
+                                                                                   cPinSelfPlayProcessesToNumaNodes);
+
+        auto learner = [&]() {
+            for(int epoch_id = 0; epoch_id < epochs; epoch_id++) {
+                // only the learner writes to the replay memory
+                auto game_replays = self_play_processes ? self_play_processes->PopTrajectory() : trajectory_queue.Pop();
+
+                for(const auto& replay: game_replays)
+                    rm.Put(replay);
+
+                std::cout << "[+] " << epoch_id << ". Round begins!" << std::endl;
+
+                // train actor and critic
+                auto replay_batch = rm.GenerateRandomBatch<BATCHSIZE>();
+
+                auto actor_out = ActorFeedForward(replay_batch.get_state(),
+                                                replay_batch.get_action_space(),
+                                                actor_model); // hier stoppt das programm!!
+
+                auto critic_out = CriticFeedForward(replay_batch.get_state(),
+                                                actor_out,
+                                                replay_batch.get_action_space(),
+                                                critic_model);
                                 
-                if(EpsylonGreedy(epochs)) {
-                    // actor takes action
-                    action_prop_distr = ActorFeedForward(cur_state,
-                                                        action_space,
-                                                        actor_model);
-
-                    action = env.ActionPropDistrToMove(action_prop_distr);
-                } else {
-                    // random action
-                    auto legal_moves = env.get_legal_moves();
-                                    
-                    auto random_action_index = rand() % legal_moves.size();
-                    action = legal_moves[random_action_index];
+                {
+                    // prevent dead roots
+                    auto critic_loss = critic_lossfunc(critic_out,
+                    replay_batch.get_return());
 
-                    action_prop_distr = env.MoveToActionPropDistr(action);
+                    critic_optimizer.Step(critic_loss);
                 }
 
-                gameover = env.MovePiece(action);
-
-                next_state = env.GenerateBoardState();
+                {
+                    // prevent dead roots
+                    auto actor_loss = critic_out.ScalarMult(ml_lib::Tensor::Scalar(-1.));
 
-                if(env.get_active_player() != env.cDefaultViewPoint) {
-                    // The agent is suppose to play against itself. That means he takes actions from pov.black and pov.white.
-                    // Normalize cur_state and next_state so both are from pov=active_player
-                    // (meaning he always views the board from his point of view)
-                    
-                    cur_state = chess_agent::Environment::SwitchBoardStatePov(cur_state);
-                    next_state= chess_agent::Environment::SwitchBoardStatePov(cur_state);
+                    actor_optimizer.Step(actor_loss);
                 }
 
-                game_replays.push_back(chess_agent::Replay(cur_state,
-                                                        next_state,
-                                                        action_prop_distr,
-                                                        action_space,
-                                                        ml_lib::Tensor::Scalar(0.)));
-            }
-
-
-            auto winner = env.get_active_player();
-            auto cur_player = chess::Piece::Colour::White;
-
-            // add replays to memory
-            for(auto replay: game_replays) {
-                replay.set_return(GenerateReturn(winner, cur_player));
-
-                rm.Put(replay);
+                // steps which start from now on use the new weights
+                if(self_play_processes) {
+                    self_play_processes->PublishWeights(actor_model);
+                } else {
+                    auto new_actor_snapshot = chess_agent::ActorSnapshot::Make(actor_model);
+                    {
+                        std::lock_guard<std::mutex> lock(actor_snapshot_mutex);
+                        actor_snapshot = new_actor_snapshot;
+                    }
+                }
 
-                cur_player = chess::Game::Opponent(cur_player);
+                checkpoint_writer.GameFinished();
             }
+        };
 
-            // train actor and critic
-            auto replay_batch = rm.GenerateRandomBatch<BATCHSIZE>();
-
-            auto actor_out = ActorFeedForward(replay_batch.get_state(),
-                                            replay_batch.get_action_space(),
-                                            actor_model); // hier stoppt das programm!!
+        // self-play worker threads are only needed without actor processes
+        std::vector<std::thread> self_play_threads;
+        for(unsigned int worker_id = 0; worker_id < num_workers && !self_play_processes; worker_id++)
+            self_play_threads.emplace_back(self_play_worker, worker_id);
 
-            auto critic_out = CriticFeedForward(replay_batch.get_state(),
-                                            actor_out,
-                                            critic_model);
-                            
-            {
-                // prevent dead roots
-                auto critic_loss = critic_lossfunc(critic_out,
-                replay_batch.get_return());
+        std::thread learner_thread(learner);
 
-                critic_optimizer.Step(critic_loss);
-            }
-
-            {
-                // prevent dead roots
-                auto actor_loss = critic_out.ScalarMult(ml_lib::Tensor::Scalar(-1.));
-
-                actor_optimizer.Step(actor_loss);
-            }
-        }
+        for(auto& self_play_thread: self_play_threads)
+            self_play_thread.join();
+        learner_thread.join();
     }
 } // namespace chess_agent
\ No newline at end of file
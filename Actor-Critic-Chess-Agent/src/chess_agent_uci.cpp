@@ -0,0 +1,320 @@
+#include "actor-critic-chess-agent/environment.h"
+
+namespace chess_agent
+{
+    namespace
+    {
+        // time lost between the engine sending its move and the clock stopping
+        const long long cMoveOverheadMs = 50;
+        // moves the remaining time is split over if the time control does not tell
+        const int cDefaultMovesToGo = 30;
+    } // namespace
+
+    UciEngine::UciEngine(const std::vector<ml_lib::LayerBase *> &actor_model) : m_actor_model(actor_model),
+                                                                               m_hash_mb(cDefaultHashMb),
+                                                                               m_num_threads(cDefaultThreads),
+                                                                               m_transposition_table(std::make_unique<chess::TranspositionTable>(cDefaultHashMb)),
+                                                                               m_search(std::make_unique<chess::Search>(*m_transposition_table, cDefaultThreads)),
+                                                                               m_board(chess::Board::BasicSetup()),
+                                                                               m_position_keys(),
+                                                                               m_environment(),
+                                                                               m_environment_follows_game(true),
+                                                                               m_searching(false),
+                                                                               m_stop_requested(false),
+                                                                               m_output(&std::cout)
+    {
+    }
+    UciEngine::~UciEngine()
+    {
+        StopSearch();
+    }
+
+    void UciEngine::Run(std::istream &input, std::ostream &output)
+    {
+        m_output = &output;
+
+        std::string line;
+        while (std::getline(input, line))
+        {
+            std::istringstream command(line);
+            std::string token;
+            command >> token;
+
+            if (token == "uci")
+            {
+                Send("id name Actor-Critic-Chess-Agent");
+                Send("id author JakobLiebig");
+                Send("option name Hash type spin default " + std::to_string(cDefaultHashMb) + " min 1 max 65536");
+                Send("option name Threads type spin default " + std::to_string(cDefaultThreads) + " min 1 max 256");
+                Send(std::string("info string actor ") + (m_actor_model.empty() ? "not loaded" : "loaded"));
+                Send("uciok");
+            }
+            else if (token == "isready")
+                Send("readyok");
+            else if (token == "setoption")
+                SetOption(command);
+            else if (token == "ucinewgame")
+            {
+                StopSearch();
+                m_transposition_table->Clear();
+            }
+            else if (token == "position")
+                SetPosition(command);
+            else if (token == "go")
+                Go(command);
+            else if (token == "stop")
+                StopSearch();
+            else if (token == "quit")
+                break;
+            else if (!token.empty())
+                Send("info string unknown command " + token);
+        }
+
+        StopSearch();
+    }
+
+    void UciEngine::SetOption(std::istringstream &command)
+    {
+        // setoption name <name> value <value>, the names used here have no spaces
+        std::string token, name, value;
+        command >> token >> name >> token >> value;
+
+        StopSearch();
+
+        try
+        {
+            if (name == "Hash")
+                m_hash_mb = std::max(1UL, std::stoul(value));
+            else if (name == "Threads")
+                m_num_threads = std::max(1UL, std::stoul(value));
+            else
+            {
+                Send("info string unknown option " + name);
+                return;
+            }
+        }
+        catch (const std::exception &)
+        {
+            Send("info string invalid value " + value + " for option " + name);
+            return;
+        }
+
+        // the search refers to the table, thus it goes first
+        m_search.reset();
+        m_transposition_table.reset();
+        m_transposition_table = std::make_unique<chess::TranspositionTable>(m_hash_mb);
+        m_search = std::make_unique<chess::Search>(*m_transposition_table, m_num_threads);
+    }
+    void UciEngine::SetPosition(std::istringstream &command)
+    {
+        StopSearch();
+
+        std::string token;
+        command >> token;
+
+        chess::Board board = chess::Board::BasicSetup();
+        bool is_start_position = token == "startpos";
+
+        if (token == "fen")
+        {
+            std::string fen;
+            while (command >> token && token != "moves")
+                fen += (fen.empty() ? "" : " ") + token;
+
+            try
+            {
+                board = chess::Board::FromFen(fen);
+            }
+            catch (const std::exception &e)
+            {
+                Send(std::string("info string invalid fen: ") + e.what());
+                return;
+            }
+        }
+        else if (is_start_position)
+        {
+            command >> token;
+        }
+        else
+        {
+            Send("info string position needs startpos or fen");
+            return;
+        }
+
+        m_board = board;
+        m_position_keys.clear();
+        m_environment.Reset();
+        m_environment_follows_game = is_start_position;
+
+        // token is "moves" if there are any
+        while (command >> token)
+        {
+            chess::Move move = ParseMove(token);
+            if (move == chess::Move())
+            {
+                Send("info string illegal move " + token);
+                return;
+            }
+
+            m_position_keys.push_back(m_board.get_key());
+            m_board.MakeMove(move);
+
+            // a finished environment game can not be moved on
+            if (m_environment_follows_game && m_environment.MovePiece(move))
+                m_environment_follows_game = false;
+        }
+    }
+    void UciEngine::Go(std::istringstream &command)
+    {
+        StopSearch();
+
+        chess::SearchLimits limits;
+        long long remaining_ms = -1;
+        long long increment_ms = 0;
+        int moves_to_go = 0;
+        bool infinite = false;
+
+        bool white_to_move = m_board.get_active_player() == chess::Piece::Colour::White;
+
+        std::string token;
+        while (command >> token)
+        {
+            if (token == "infinite")
+            {
+                infinite = true;
+                continue;
+            }
+
+            long long value;
+            if (!(command >> value))
+                break;
+
+            if (token == (white_to_move ? "wtime" : "btime"))
+                remaining_ms = value;
+            else if (token == (white_to_move ? "winc" : "binc"))
+                increment_ms = value;
+            else if (token == "movestogo")
+                moves_to_go = (int)value;
+            else if (token == "movetime")
+                limits.movetime = std::chrono::milliseconds(std::max(1LL, value - cMoveOverheadMs));
+            else if (token == "depth")
+                limits.depth = (int)std::max(1LL, value);
+            else if (token == "nodes")
+                limits.nodes = (unsigned long long)std::max(1LL, value);
+        }
+
+        if (limits.movetime.count() == 0 && remaining_ms >= 0 && !infinite)
+            limits.movetime = AllocateTime(remaining_ms, increment_ms, moves_to_go);
+
+        // the search tries the hash move first, an entry without depth never cuts the search short
+        // a root entry of an earlier search already knows a better move than the actor
+        chess::Move actor_move = ActorMove();
+        chess::TranspositionTable::Entry entry;
+        if (!(actor_move == chess::Move()) &&
+            (!m_transposition_table->Probe(m_board.get_key(), entry) || entry.move == chess::Move()))
+            m_transposition_table->Store(m_board.get_key(), actor_move, 0, 0, chess::TranspositionTable::Bound::Upper);
+
+        m_searching.store(true);
+        m_stop_requested.store(false);
+
+        m_search_thread = std::thread([this, limits, infinite, board = m_board, position_keys = m_position_keys]()
+                                      {
+                                          chess::SearchReport report = m_search->Run(board, position_keys, limits, [this](const chess::SearchReport &report)
+                                                                                     { SendReport(report); });
+
+                                          while (infinite && !m_stop_requested.load())
+                                              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+                                          Send("bestmove " + (report.pv.empty() ? std::string("0000") : report.pv[0].ToString()));
+                                          m_searching.store(false);
+                                      });
+    }
+    void UciEngine::StopSearch()
+    {
+        if (!m_search_thread.joinable())
+            return;
+
+        m_stop_requested.store(true);
+
+        // Search::Run clears a stop which comes before it started, thus it is repeated until the search is done
+        while (m_searching.load())
+        {
+            m_search->Stop();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        m_search_thread.join();
+    }
+
+    chess::Move UciEngine::ParseMove(const std::string &move_string) const
+    {
+        if (move_string.size() < 4 || move_string.size() > 5)
+            return chess::Move();
+
+        for (const chess::Move &legal_move : m_board.GenerateLegalMoves())
+        {
+            if (legal_move.ToString() == move_string)
+                return legal_move;
+        }
+
+        return chess::Move();
+    }
+    chess::Move UciEngine::ActorMove()
+    {
+        if (m_actor_model.empty() || !m_environment_follows_game)
+            return chess::Move();
+
+        auto action_prop_distr = ActorFeedForward(m_environment.GenerateSparseBoardState(), m_environment.GenerateActionSpace(), m_actor_model);
+        chess::Move actor_action = m_environment.ActionPropDistrToMove(action_prop_distr);
+
+        // the actor only names the fields, promotions become queens like in Game::MovePiece
+        chess::Move actor_move;
+        for (const chess::Move &legal_move : m_board.GenerateLegalMoves())
+        {
+            if (legal_move.get_from() == actor_action.get_from() && legal_move.get_to() == actor_action.get_to() &&
+                (!legal_move.isPawnPromotion() || legal_move.get_promotion_type() == chess::Piece::Type::Queen))
+                actor_move = legal_move;
+        }
+
+        return actor_move;
+    }
+    std::chrono::milliseconds UciEngine::AllocateTime(const long long &remaining_ms, const long long &increment_ms, const int &moves_to_go)
+    {
+        // an equal share of the remaining time plus most of the increment, never more than is left on the clock
+        long long time_ms = remaining_ms / (moves_to_go > 0 ? moves_to_go : cDefaultMovesToGo) + increment_ms * 3 / 4;
+        time_ms = std::min(time_ms, remaining_ms - cMoveOverheadMs);
+
+        return std::chrono::milliseconds(std::max(1LL, time_ms));
+    }
+
+    void UciEngine::Send(const std::string &line)
+    {
+        std::lock_guard<std::mutex> lock(m_output_mutex);
+        *m_output << line << std::endl;
+    }
+    void UciEngine::SendReport(const chess::SearchReport &report)
+    {
+        std::string score;
+        if (chess::Search::isMateScore(report.score))
+        {
+            // uci counts moves, not plies, negative if the engine gets mated
+            int plies = chess::Search::cMateScore - std::abs(report.score);
+            score = "mate " + std::to_string(report.score > 0 ? (plies + 1) / 2 : -plies / 2);
+        }
+        else
+            score = "cp " + std::to_string(report.score);
+
+        std::string line = "info depth " + std::to_string(report.depth) +
+                           " score " + score +
+                           " nodes " + std::to_string(report.nodes) +
+                           " nps " + std::to_string(report.nodes_per_second) +
+                           " hashfull " + std::to_string(report.hashfull) +
+                           " time " + std::to_string((long long)(report.seconds * 1000)) +
+                           " pv";
+
+        for (const chess::Move &move : report.pv)
+            line += " " + move.ToString();
+
+        Send(line);
+    }
+} // namespace chess_agent
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <stdexcept>
+
+#include "ml_lib/model.h"
+#include "ml_lib/checkpoint.h"
+
+// an AsyncWriter on the prefix of a previous run has to continue its numbering and prune its checkpoints
+
+bool Check(const bool &condition, const std::string &description)
+{
+    std::cout << (condition ? "[+] " : "[-] ") << description << std::endl;
+
+    return condition;
+}
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "checkpoint_restart_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    std::string prefix = (directory / "actor").string();
+    auto checkpoint_path = [&prefix](const unsigned int &id)
+    { return prefix + "." + std::to_string(id) + ".ckpt"; };
+
+    ml_lib::layer_type::Linear layer(16, 8, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+    std::vector<ml_lib::LayerBase *> model = {&layer};
+    ml_lib::optimizer::MiniBatchSgd optimizer(model, 0.1);
+
+    bool passed = true;
+
+    // first run writes 0, 1 and 2, keeping the last two
+    {
+        ml_lib::checkpoint::AsyncWriter writer(prefix, 2, 0, 0.);
+        writer.Track("actor", optimizer.get_learnable_parameters());
+
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            writer.Save();
+            writer.Flush();
+        }
+    }
+
+    passed &= Check(!std::filesystem::exists(checkpoint_path(0)) && std::filesystem::exists(checkpoint_path(1)) &&
+                        std::filesystem::exists(checkpoint_path(2)),
+                    "first run keeps the last two checkpoints");
+
+    // the restarted run must neither overwrite 0 nor leave 1 behind
+    {
+        ml_lib::checkpoint::AsyncWriter writer(prefix, 2, 0, 0.);
+        writer.Track("actor", optimizer.get_learnable_parameters());
+
+        writer.Save();
+        writer.Flush();
+    }
+
+    passed &= Check(!std::filesystem::exists(checkpoint_path(0)) && !std::filesystem::exists(checkpoint_path(1)) &&
+                        std::filesystem::exists(checkpoint_path(2)) && std::filesystem::exists(checkpoint_path(3)),
+                    "restarted run continues at 3 and prunes the previous run");
+    passed &= Check(!std::filesystem::exists(checkpoint_path(3) + ".tmp"), "no temporary file is left behind");
+
+    ml_lib::layer_type::Linear loaded_layer(16, 8, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+    std::vector<ml_lib::LayerBase *> loaded_model = {&loaded_layer};
+    ml_lib::checkpoint::Load(checkpoint_path(3), loaded_model, "actor");
+
+    passed &= Check(loaded_layer.get_weight(3, 5) == layer.get_weight(3, 5), "restarted checkpoint loads");
+
+    bool rejected = false;
+    try
+    {
+        ml_lib::checkpoint::AsyncWriter writer(prefix, 0, 0, 0.);
+    }
+    catch (const std::invalid_argument &)
+    {
+        rejected = true;
+    }
+
+    passed &= Check(rejected && std::filesystem::exists(checkpoint_path(3)), "keeping no checkpoints is rejected");
+
+    std::filesystem::remove_all(directory);
+
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+
+#include "ml_lib/model.h"
+#include "ml_lib/accumulator.h"
+
+#include "actor-critic-chess-agent/environment.h"
+
+// MovePiece followed by UndoMove has to restore the game and the linked accumulators
+// the accumulators are compared against ones refreshed from scratch after every undo
+
+bool isEqual(const ml_lib::Accumulator &a, const ml_lib::Accumulator &b)
+{
+    std::vector<double> a_values(1024), b_values(1024);
+    a.CopyPreActivations(a_values.data());
+    b.CopyPreActivations(b_values.data());
+
+    for (unsigned int i = 0; i < a_values.size(); i++)
+    {
+        if (std::abs(a_values[i] - b_values[i]) > 1e-9)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::srand(0);
+    ml_lib::layer_type::Linear layer(2048, 1024, ml_lib::initializer::Jakob, ml_lib::initializer::Jakob);
+
+    chess_agent::Environment env;
+    ml_lib::Accumulator white_accumulator(&layer);
+    ml_lib::Accumulator black_accumulator(&layer);
+    env.LinkAccumulator(&white_accumulator, chess::Piece::Colour::White);
+    env.LinkAccumulator(&black_accumulator, chess::Piece::Colour::Black);
+
+    std::mt19937 rng(0);
+    unsigned int num_failed = 0;
+
+    for (unsigned int game = 0; game < 8; game++)
+    {
+        env.Reset();
+
+        std::vector<chess::zobrist::Key> keys;
+        while (keys.size() < 40)
+        {
+            auto legal_moves = env.get_legal_moves();
+            keys.push_back(env.get_board().get_key());
+
+            if (env.MovePiece(legal_moves[rng() % legal_moves.size()]))
+                break;
+        }
+
+        while (!keys.empty())
+        {
+            env.UndoMove();
+
+            ml_lib::Accumulator white_refreshed(&layer);
+            ml_lib::Accumulator black_refreshed(&layer);
+            white_refreshed.Refresh(env.GenerateSparseBoardState());
+            black_refreshed.Refresh(chess_agent::Environment::SwitchBoardStatePov(env.GenerateSparseBoardState()));
+
+            if (env.get_board().get_key() != keys.back() || !isEqual(white_accumulator, white_refreshed) ||
+                !isEqual(black_accumulator, black_refreshed))
+                num_failed++;
+
+            keys.pop_back();
+        }
+    }
+
+    std::cout << (num_failed == 0 ? "[+] " : "[-] ") << "environment undo: " << num_failed << " mismatches" << std::endl;
+
+    return num_failed == 0 ? 0 : 1;
+}
\ No newline at end of file